@@ -0,0 +1,89 @@
+#include "AsyncItemFetcher.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <system_error>
+#include <utility>
+
+// If some threads cannot be started, the fetcher runs with those that could.
+AsyncItemFetcher::AsyncItemFetcher(unsigned threadCount) {
+  if (threadCount == 0) {
+    threadCount = std::max(1u, std::thread::hardware_concurrency());
+  }
+  mWorkers.reserve(threadCount);
+  for (unsigned threadIndex = 0; threadIndex < threadCount; ++threadIndex) {
+    try {
+      mWorkers.emplace_back([this]() { runWorker(); });
+    } catch (const std::system_error&) {
+      if (mWorkers.empty()) {
+        throw;
+      }
+      break;
+    }
+  }
+}
+
+AsyncItemFetcher::~AsyncItemFetcher() {
+  std::deque<Request> abandonedRequests;
+  {
+    std::lock_guard<std::mutex> lock(mMutex);
+    mIsStopping = true;
+    abandonedRequests.swap(mRequests);
+  }
+  mRequestAvailable.notify_all();
+  for (std::thread& worker : mWorkers) {
+    worker.join();
+  }
+
+  for (Request& request : abandonedRequests) {
+    FetchResult result;
+    result.failure = std::make_exception_ptr(std::runtime_error("Fetch cancelled"));
+    request.onCompleted(std::move(result));
+  }
+}
+
+// The promise is shared with the completion, which std::function requires to be copyable.
+std::future<Item> AsyncItemFetcher::FetchAsync(const char* itemIdentifier) {
+  auto promise = std::make_shared<std::promise<Item>>();
+  std::future<Item> future = promise->get_future();
+  FetchAsync(itemIdentifier, [promise](FetchResult&& result) {
+    if (result.item) {
+      promise->set_value(std::move(*result.item));
+    } else {
+      promise->set_exception(result.failure);
+    }
+  });
+  return future;
+}
+
+void AsyncItemFetcher::FetchAsync(const char* itemIdentifier, Completion onCompleted) {
+  Request request{itemIdentifier ? itemIdentifier : "", itemIdentifier == nullptr, std::move(onCompleted)};
+  {
+    std::lock_guard<std::mutex> lock(mMutex);
+    mRequests.push_back(std::move(request));
+  }
+  mRequestAvailable.notify_one();
+}
+
+void AsyncItemFetcher::runWorker() {
+  for (;;) {
+    Request request;
+    {
+      std::unique_lock<std::mutex> lock(mMutex);
+      mRequestAvailable.wait(lock, [this]() { return mIsStopping || !mRequests.empty(); });
+      if (mIsStopping) {
+        return;
+      }
+      request = std::move(mRequests.front());
+      mRequests.pop_front();
+    }
+
+    FetchResult result;
+    try {
+      result.item = std::make_unique<Item>(request.isRandom ? nullptr : &request.itemIdentifier[0]);
+    } catch (...) {
+      result.failure = std::current_exception();
+    }
+    request.onCompleted(std::move(result));
+  }
+}
@@ -0,0 +1,81 @@
+#pragma once
+
+#include "Item.h"
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// =============================================================================
+// AsyncItemFetcher: Constructs Items from the item source on worker threads.
+//
+// The ID-based Item constructors block until the data provider (or the
+// plugged-in ItemSource) answers. A fetcher runs those constructions on a
+// small pool of threads instead, so that many provider requests are in
+// flight at once while the calling thread does other work, e.g. inserting
+// the items that have already arrived (see DataStructure::LoadAsync).
+//
+// Requests are served in submission order, but finish in whatever order the
+// provider answers. Items are built exactly as by Item(char*), including the
+// provider cache. All member functions are thread-safe.
+// =============================================================================
+class AsyncItemFetcher
+{
+public:
+  // Outcome of one request: item is set on success, failure otherwise.
+  struct FetchResult {
+    std::unique_ptr<Item> item;
+    std::exception_ptr failure;
+  };
+
+  // Called on a worker thread once a request has finished. It must not
+  // throw and should return quickly, since the worker fetches nothing else
+  // in the meantime.
+  using Completion = std::function<void(FetchResult&& result)>;
+
+  // Starts threadCount worker threads (0 means one per hardware thread).
+  // Throws std::system_error if no thread can be started.
+  explicit AsyncItemFetcher(unsigned threadCount = 0);
+
+  AsyncItemFetcher(const AsyncItemFetcher&) = delete;
+  AsyncItemFetcher& operator=(const AsyncItemFetcher&) = delete;
+
+  // Stops the workers after their current fetch. Requests that have not
+  // started yet are completed with a std::runtime_error.
+  ~AsyncItemFetcher();
+
+  // Returns the number of worker threads.
+  std::size_t GetThreadCount() const { return mWorkers.size(); }
+
+  // Queues the construction of the item with the given ID (copied), or of a
+  // random item if pID is nullptr. The future holds the item or rethrows the
+  // exception of its constructor.
+  std::future<Item> FetchAsync(const char* pID);
+
+  // Same as FetchAsync, but hands the result to onCompleted instead.
+  void FetchAsync(const char* pID, Completion onCompleted);
+
+private:
+  struct Request {
+    std::string itemIdentifier;
+    bool isRandom;
+    Completion onCompleted;
+  };
+
+  // Takes requests off the queue until the fetcher is stopped.
+  void runWorker();
+
+  std::mutex mMutex;
+  std::condition_variable mRequestAvailable;
+  std::deque<Request> mRequests;
+  bool mIsStopping = false;
+  std::vector<std::thread> mWorkers;
+};
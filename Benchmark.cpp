@@ -0,0 +1,541 @@
+#include "AsyncItemFetcher.h"
+#include "DataStructure.h"
+#include "Item.h"
+#include "SyntheticItemSource.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <memory_resource>
+#include <random>
+#include <streambuf>
+#include <string>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+// =============================================================================
+// Benchmark suite for the DataStructure hot paths.
+//
+// Measures operator+=, BuildParallel, GetItem and GetItems (hit and miss),
+// Contains, operator-=, GetItemsNumber, GetCodeStatistics, ForEachWithPrefix,
+// ForEachWithCode, ForEachInTimeRange, operator<< and Export (in each
+// format) for item counts from 1k to 10M, in
+// the style of Google Benchmark: one line per case with the time per
+// operation and the throughput.
+//
+// The IDs are drawn from Colors.txt in two distributions:
+// - realistic:   all two-word colour names, made unique by appending "-<n>"
+//                suffixes, so the letter-pair skew of Colors.txt is kept
+// - adversarial: "Cameo Pink-<n>" only, so every item lands in one list
+//
+// Each distribution runs against the plain layout, the ID index, the ID
+// index combined with the string arena, the ID index combined with the Code
+// and time indexes, the ID index with list nodes on the heap instead of the
+// node pool, and the hashed-array bucket layout with and without the ID
+// index. Items are built from plain ITEM1
+// records, so the data provider DLL is not involved in any measurement.
+//
+// Fetching from a slow provider is measured separately: LoadBulk(IDs) and
+// LoadAsync against a SyntheticItemSource that waits PROVIDER_LATENCY_US
+// per item, which shows how much of the latency the fetcher hides.
+//
+// Cases whose list scans would exceed the comparison budget (e.g. 10M items
+// in one list) are reported as skipped instead of running for hours.
+//
+// Usage: benchmark [--colors <path>] [--max-items <n>] [--budget <n>] [--filter <text>]
+// =============================================================================
+
+namespace {
+
+constexpr std::size_t MIN_ITEM_COUNT = 1000;
+constexpr std::size_t MAX_ITEM_COUNT = 10000000;
+constexpr std::size_t MAX_QUERY_COUNT = 1000000;
+constexpr std::size_t COUNT_QUERY_COUNT = 10000000;
+constexpr std::size_t PREFIX_QUERY_COUNT = 1000;
+constexpr std::size_t ATTRIBUTE_QUERY_COUNT = 1000;
+constexpr std::size_t BATCH_SIZE = 256;
+constexpr std::size_t PROVIDER_ITEM_COUNT = 2000;
+constexpr unsigned PROVIDER_LATENCY_US = 100;
+constexpr unsigned PROVIDER_FETCH_THREADS = 8;
+constexpr double DEFAULT_COMPARISON_BUDGET = 2e9;
+
+// Command line settings.
+struct Settings {
+  std::string colorsPath = "Colors.txt";
+  std::size_t maxItemCount = MAX_ITEM_COUNT;
+  double comparisonBudget = DEFAULT_COMPARISON_BUDGET;
+  std::string filter;
+};
+
+// A DataStructure configuration under test.
+struct Layout {
+  const char* name;
+  DataStructure::Options options;
+};
+
+// A set of generated IDs and the number of distinct letter-pair lists they use.
+struct Distribution {
+  const char* name;
+  std::vector<std::string> identifiers;
+  std::size_t occupiedListCount;
+};
+
+// Stream buffer that discards everything, so operator<< is timed without I/O.
+class NullBuffer : public std::streambuf
+{
+protected:
+  int overflow(int character) override { return character; }
+  std::streamsize xsputn(const char*, std::streamsize count) override { return count; }
+};
+
+// Keeps results alive so the compiler cannot drop the measured calls.
+volatile std::size_t benchmarkSink = 0;
+
+double secondsSince(std::chrono::steady_clock::time_point start) {
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Prints one result line: name, time per operation, operations, throughput.
+void reportResult(const std::string& name, double seconds, std::size_t operationCount) {
+  const double nanosecondsPerOperation = seconds * 1e9 / static_cast<double>(operationCount);
+  const double operationsPerSecond = static_cast<double>(operationCount) / seconds;
+  std::printf("%-52s %12.1f ns %12zu %10.2fM items/s\n", name.c_str(), nanosecondsPerOperation, operationCount,
+              operationsPerSecond / 1e6);
+}
+
+void reportSkipped(const std::string& name, double estimatedComparisons) {
+  std::printf("%-52s skipped (~%.1e comparisons over budget)\n", name.c_str(), estimatedComparisons);
+}
+
+// Reads the two-word names from Colors.txt (skipping a UTF-8 byte order mark).
+std::vector<std::string> readColorNames(const std::string& colorsPath) {
+  std::ifstream colorsFile(colorsPath);
+  if (!colorsFile) {
+    throw std::runtime_error("Cannot open " + colorsPath);
+  }
+
+  std::vector<std::string> colorNames;
+  std::string line;
+  while (std::getline(colorsFile, line)) {
+    if (line.compare(0, 3, "\xEF\xBB\xBF") == 0) {
+      line.erase(0, 3);
+    }
+    while (!line.empty() && (line.back() == '\r' || line.back() == ' ')) {
+      line.pop_back();
+    }
+    const std::size_t spacePosition = line.find(' ');
+    if (spacePosition == std::string::npos || line.find(' ', spacePosition + 1) != std::string::npos ||
+        line[0] < 'A' || line[0] > 'Z' || line[spacePosition + 1] < 'A' || line[spacePosition + 1] > 'Z') {
+      continue;
+    }
+    colorNames.push_back(line);
+  }
+  std::sort(colorNames.begin(), colorNames.end());
+  colorNames.erase(std::unique(colorNames.begin(), colorNames.end()), colorNames.end());
+  if (colorNames.empty()) {
+    throw std::runtime_error("No two-word colour names in " + colorsPath);
+  }
+  return colorNames;
+}
+
+// Generates itemCount unique IDs by cycling through baseNames and appending
+// "-<letters>" once the names are used up. Letters keep the IDs valid.
+std::vector<std::string> generateIdentifiers(const std::vector<std::string>& baseNames, std::size_t itemCount) {
+  std::vector<std::string> identifiers;
+  identifiers.reserve(itemCount);
+  std::unordered_set<std::string> usedIdentifiers;
+  usedIdentifiers.reserve(itemCount);
+  for (std::size_t counter = 0; identifiers.size() < itemCount; ++counter) {
+    std::string identifier = baseNames[counter % baseNames.size()];
+    std::size_t round = counter / baseNames.size();
+    if (round > 0) {
+      identifier += '-';
+      for (; round > 0; round /= 26) {
+        identifier += static_cast<char>('a' + round % 26);
+      }
+    }
+    if (usedIdentifiers.insert(identifier).second) {
+      identifiers.push_back(std::move(identifier));
+    }
+  }
+  return identifiers;
+}
+
+std::size_t countOccupiedLists(const std::vector<std::string>& identifiers) {
+  std::unordered_set<int> listKeys;
+  for (const std::string& identifier : identifiers) {
+    listKeys.insert(identifier[0] * 256 + identifier[identifier.find(' ') + 1]);
+  }
+  return listKeys.size();
+}
+
+// Builds the items for the first itemCount IDs with random Code and pTime,
+// from plain ITEM1 records rather than through the data provider.
+std::vector<Item> buildItems(const std::vector<std::string>& identifiers, std::size_t itemCount, std::mt19937& random) {
+  std::vector<Item> items;
+  items.reserve(itemCount);
+  char timeBuffer[9];
+  for (std::size_t itemIndex = 0; itemIndex < itemCount; ++itemIndex) {
+    std::snprintf(timeBuffer, sizeof(timeBuffer), "%02u:%02u:%02u", static_cast<unsigned>(random() % 24),
+                  static_cast<unsigned>(random() % 60), static_cast<unsigned>(random() % 60));
+    ITEM1 record{const_cast<char*>(identifiers[itemIndex].c_str()), random(), timeBuffer, nullptr};
+    items.emplace_back(record);
+  }
+  return items;
+}
+
+// Runs every benchmark of one distribution, layout and size.
+void runCase(const Distribution& distribution, const Layout& layout, std::size_t itemCount,
+             const Settings& settings) {
+  const std::string prefix = std::string(distribution.name) + "/" + layout.name + "/";
+  const std::string suffix = "/" + std::to_string(itemCount);
+  auto isSelected = [&settings](const std::string& name) {
+    return settings.filter.empty() || name.find(settings.filter) != std::string::npos;
+  };
+
+  // Average number of comparisons per scan of a list. The hashed layout
+  // compares 16 fingerprints at a time.
+  const double comparisonsPerEntry = layout.options.bucketLayout == DataStructure::BucketLayout::HashedArrays ? 1.0 / 16 : 1.0;
+  const double averageListLength =
+      comparisonsPerEntry * static_cast<double>(itemCount) / static_cast<double>(distribution.occupiedListCount);
+  const bool hasIdIndex = layout.options.useIdIndex;
+  auto fitsBudget = [&](const std::string& name, double operationCount, double comparisonsPerOperation) {
+    const double estimatedComparisons = operationCount * comparisonsPerOperation;
+    if (estimatedComparisons > settings.comparisonBudget) {
+      if (isSelected(name)) {
+        reportSkipped(name, estimatedComparisons);
+      }
+      return false;
+    }
+    return isSelected(name);
+  };
+
+  // Inserting and removing need a filled structure for every other case,
+  // so the build is skipped only if the inserts alone are over budget.
+  const std::string insertName = prefix + "Insert" + suffix;
+  const double insertScanLength = hasIdIndex ? 1.0 : averageListLength / 2;
+  if (static_cast<double>(itemCount) * insertScanLength > settings.comparisonBudget) {
+    reportSkipped(prefix + "*" + suffix, static_cast<double>(itemCount) * insertScanLength);
+    return;
+  }
+
+  std::mt19937 random(static_cast<unsigned>(itemCount));
+  std::vector<Item> items = buildItems(distribution.identifiers, itemCount, random);
+  DataStructure dataStructure(layout.options);
+
+  auto start = std::chrono::steady_clock::now();
+  for (Item& item : items) {
+    dataStructure += item;
+  }
+  const double insertSeconds = secondsSince(start);
+  if (isSelected(insertName)) {
+    reportResult(insertName, insertSeconds, itemCount);
+  }
+
+  const std::size_t queryCount = std::min(itemCount, MAX_QUERY_COUNT);
+  std::vector<std::string> hitQueries;
+  std::vector<std::string> missQueries;
+  hitQueries.reserve(queryCount);
+  missQueries.reserve(queryCount);
+  for (std::size_t queryIndex = 0; queryIndex < queryCount; ++queryIndex) {
+    hitQueries.push_back(distribution.identifiers[random() % itemCount]);
+    // '!' never occurs in a generated ID, but the query still maps to a real list.
+    missQueries.push_back(hitQueries.back() + "!");
+  }
+
+  const std::string hitName = prefix + "GetItem/hit" + suffix;
+  if (fitsBudget(hitName, static_cast<double>(queryCount), hasIdIndex ? 1.0 : averageListLength / 2)) {
+    start = std::chrono::steady_clock::now();
+    for (std::string& query : hitQueries) {
+      benchmarkSink += dataStructure.GetItem(&query[0]) != nullptr;
+    }
+    reportResult(hitName, secondsSince(start), queryCount);
+  }
+
+  const std::string missName = prefix + "GetItem/miss" + suffix;
+  if (fitsBudget(missName, static_cast<double>(queryCount), hasIdIndex ? 1.0 : averageListLength)) {
+    start = std::chrono::steady_clock::now();
+    for (std::string& query : missQueries) {
+      benchmarkSink += dataStructure.GetItem(&query[0]) != nullptr;
+    }
+    reportResult(missName, secondsSince(start), queryCount);
+  }
+
+  // The hit queries again, passed as views of the strings instead of char*.
+  const std::string containsName = prefix + "Contains/hit" + suffix;
+  if (fitsBudget(containsName, static_cast<double>(queryCount), hasIdIndex ? 1.0 : averageListLength / 2)) {
+    start = std::chrono::steady_clock::now();
+    for (const std::string& query : hitQueries) {
+      benchmarkSink += dataStructure.Contains(query);
+    }
+    reportResult(containsName, secondsSince(start), queryCount);
+  }
+
+  // The same queries through GetItems, in batches as a request handler would send them.
+  auto runBatches = [&](const std::string& name, std::vector<std::string>& queries, double comparisonsPerQuery) {
+    if (!fitsBudget(name, static_cast<double>(queryCount), comparisonsPerQuery)) {
+      return;
+    }
+    std::vector<char*> batchIdentifiers;
+    batchIdentifiers.reserve(queries.size());
+    for (std::string& query : queries) {
+      batchIdentifiers.push_back(&query[0]);
+    }
+    std::vector<Item*> batchItems(BATCH_SIZE);
+    start = std::chrono::steady_clock::now();
+    for (std::size_t batchStart = 0; batchStart < batchIdentifiers.size(); batchStart += BATCH_SIZE) {
+      const std::size_t batchLength = std::min(BATCH_SIZE, batchIdentifiers.size() - batchStart);
+      benchmarkSink += static_cast<std::size_t>(
+          dataStructure.GetItems(&batchIdentifiers[batchStart], static_cast<int>(batchLength), batchItems.data()));
+    }
+    reportResult(name, secondsSince(start), queryCount);
+  };
+  runBatches(prefix + "GetItems/hit" + suffix, hitQueries, hasIdIndex ? 1.0 : averageListLength / 2);
+  runBatches(prefix + "GetItems/miss" + suffix, missQueries, hasIdIndex ? 1.0 : averageListLength);
+
+  const std::string countName = prefix + "GetItemsNumber" + suffix;
+  if (isSelected(countName)) {
+    start = std::chrono::steady_clock::now();
+    for (std::size_t callIndex = 0; callIndex < COUNT_QUERY_COUNT; ++callIndex) {
+      benchmarkSink += static_cast<std::size_t>(dataStructure.GetItemsNumber());
+    }
+    reportResult(countName, secondsSince(start), COUNT_QUERY_COUNT);
+  }
+
+  const std::string statisticsName = prefix + "GetCodeStatistics" + suffix;
+  if (isSelected(statisticsName)) {
+    start = std::chrono::steady_clock::now();
+    benchmarkSink += static_cast<std::size_t>(dataStructure.GetCodeStatistics().sum);
+    reportResult(statisticsName, secondsSince(start), itemCount);
+  }
+
+  // Two-letter prefixes of stored IDs, as typed into an autocompletion box.
+  // Each query scans one bucket, i.e. up to all items.
+  const std::string prefixName = prefix + "ForEachWithPrefix" + suffix;
+  const std::size_t prefixQueryCount = std::min(queryCount, PREFIX_QUERY_COUNT);
+  if (fitsBudget(prefixName, static_cast<double>(prefixQueryCount), static_cast<double>(itemCount))) {
+    start = std::chrono::steady_clock::now();
+    for (std::size_t queryIndex = 0; queryIndex < prefixQueryCount; ++queryIndex) {
+      const std::string queryPrefix = hitQueries[queryIndex].substr(0, 2);
+      dataStructure.ForEachWithPrefix(queryPrefix.c_str(), [](const Item&) { ++benchmarkSink; });
+    }
+    reportResult(prefixName, secondsSince(start), prefixQueryCount);
+  }
+
+  // Codes of stored items, and 90-minute windows starting on a random
+  // quarter hour, as a report would request them. Without the
+  // corresponding index each query scans all items.
+  const std::size_t attributeQueryCount = std::min(queryCount, ATTRIBUTE_QUERY_COUNT);
+  const std::string codeName = prefix + "ForEachWithCode" + suffix;
+  if (fitsBudget(codeName, static_cast<double>(attributeQueryCount),
+                 layout.options.useCodeIndex ? 1.0 : static_cast<double>(itemCount))) {
+    std::vector<unsigned long> codeQueries;
+    for (std::size_t queryIndex = 0; queryIndex < attributeQueryCount; ++queryIndex) {
+      codeQueries.push_back(items[random() % itemCount].Code);
+    }
+    start = std::chrono::steady_clock::now();
+    for (unsigned long code : codeQueries) {
+      dataStructure.ForEachWithCode(code, [](const Item&) { ++benchmarkSink; });
+    }
+    reportResult(codeName, secondsSince(start), attributeQueryCount);
+  }
+
+  const std::string timeName = prefix + "ForEachInTimeRange" + suffix;
+  if (fitsBudget(timeName, static_cast<double>(attributeQueryCount),
+                 layout.options.useTimeIndex ? static_cast<double>(itemCount) / 16 : static_cast<double>(itemCount))) {
+    std::vector<std::pair<std::string, std::string>> timeQueries;
+    char timeBuffer[9];
+    for (std::size_t queryIndex = 0; queryIndex < attributeQueryCount; ++queryIndex) {
+      const unsigned firstMinute = static_cast<unsigned>(random() % (24 * 4 - 6)) * 15;
+      const unsigned lastMinute = firstMinute + 90;
+      std::snprintf(timeBuffer, sizeof(timeBuffer), "%02u:%02u:00", firstMinute / 60, firstMinute % 60);
+      std::string firstTime = timeBuffer;
+      std::snprintf(timeBuffer, sizeof(timeBuffer), "%02u:%02u:00", lastMinute / 60, lastMinute % 60);
+      timeQueries.emplace_back(std::move(firstTime), timeBuffer);
+    }
+    start = std::chrono::steady_clock::now();
+    for (const auto& timeQuery : timeQueries) {
+      dataStructure.ForEachInTimeRange(timeQuery.first.c_str(), timeQuery.second.c_str(),
+                                       [](const Item&) { ++benchmarkSink; });
+    }
+    reportResult(timeName, secondsSince(start), attributeQueryCount);
+  }
+
+  const std::string printName = prefix + "operator<<" + suffix;
+  if (isSelected(printName)) {
+    NullBuffer nullBuffer;
+    std::ostream nullStream(&nullBuffer);
+    start = std::chrono::steady_clock::now();
+    nullStream << dataStructure;
+    reportResult(printName, secondsSince(start), itemCount);
+  }
+
+  // Each export format into a reused buffer, i.e. without I/O or reallocation.
+  const std::pair<const char*, DataStructure::ExportFormat> exportFormats[] = {
+      {"lines", DataStructure::ExportFormat::Lines},
+      {"csv", DataStructure::ExportFormat::Csv},
+      {"ndjson", DataStructure::ExportFormat::Ndjson}};
+  std::string exportBuffer;
+  for (const auto& exportFormat : exportFormats) {
+    const std::string exportName = prefix + "Export/" + exportFormat.first + suffix;
+    if (isSelected(exportName)) {
+      dataStructure.Export(exportBuffer, exportFormat.second);
+      exportBuffer.clear();
+      start = std::chrono::steady_clock::now();
+      benchmarkSink += dataStructure.Export(exportBuffer, exportFormat.second);
+      reportResult(exportName, secondsSince(start), itemCount);
+      benchmarkSink += exportBuffer.size();
+      exportBuffer.clear();
+    }
+  }
+
+  // Removal still walks the list to unlink the node, even with the ID index.
+  const std::string removeName = prefix + "Remove" + suffix;
+  if (fitsBudget(removeName, static_cast<double>(itemCount), averageListLength / 2)) {
+    std::vector<std::string> removalOrder(distribution.identifiers.begin(),
+                                          distribution.identifiers.begin() + static_cast<std::ptrdiff_t>(itemCount));
+    std::shuffle(removalOrder.begin(), removalOrder.end(), random);
+    start = std::chrono::steady_clock::now();
+    for (std::string& identifier : removalOrder) {
+      dataStructure -= &identifier[0];
+    }
+    reportResult(removeName, secondsSince(start), itemCount);
+  }
+
+  // The same items once more, added by BuildParallel on all hardware threads.
+  const std::string parallelName = prefix + "BuildParallel" + suffix;
+  if (fitsBudget(parallelName, static_cast<double>(itemCount), insertScanLength)) {
+    DataStructure parallelStructure(layout.options);
+    start = std::chrono::steady_clock::now();
+    benchmarkSink += static_cast<std::size_t>(parallelStructure.BuildParallel(items));
+    reportResult(parallelName, secondsSince(start), itemCount);
+  }
+}
+
+// Loads the same IDs through the synthetic provider, once fetching one item
+// after another and once with PROVIDER_FETCH_THREADS fetches in flight.
+void runProviderCases(const Distribution& distribution, const Settings& settings) {
+  const std::string suffix = "/" + std::to_string(PROVIDER_ITEM_COUNT);
+  const std::string bulkName = std::string("provider/") + distribution.name + "/LoadBulk" + suffix;
+  const std::string asyncName = std::string("provider/") + distribution.name + "/LoadAsync" + suffix;
+  auto isSelected = [&settings](const std::string& name) {
+    return settings.filter.empty() || name.find(settings.filter) != std::string::npos;
+  };
+  if (!isSelected(bulkName) && !isSelected(asyncName)) {
+    return;
+  }
+
+  SyntheticItemSource::Options sourceOptions;
+  sourceOptions.colorsPath = settings.colorsPath;
+  sourceOptions.fetchLatencyMicroseconds = PROVIDER_LATENCY_US;
+  SyntheticItemSource slowSource(sourceOptions);
+  Item::SetItemSource(&slowSource);
+
+  std::vector<std::string> identifiers(distribution.identifiers.begin(),
+                                       distribution.identifiers.begin() +
+                                           static_cast<std::ptrdiff_t>(std::min(PROVIDER_ITEM_COUNT, distribution.identifiers.size())));
+  std::vector<char*> identifierPointers;
+  for (std::string& identifier : identifiers) {
+    identifierPointers.push_back(&identifier[0]);
+  }
+  const int identifierCount = static_cast<int>(identifierPointers.size());
+
+  if (isSelected(bulkName)) {
+    DataStructure dataStructure;
+    const auto start = std::chrono::steady_clock::now();
+    benchmarkSink += static_cast<std::size_t>(dataStructure.LoadBulk(identifierPointers.data(), identifierCount));
+    reportResult(bulkName, secondsSince(start), identifierPointers.size());
+  }
+  if (isSelected(asyncName)) {
+    AsyncItemFetcher fetcher(PROVIDER_FETCH_THREADS);
+    DataStructure dataStructure;
+    const auto start = std::chrono::steady_clock::now();
+    benchmarkSink +=
+        static_cast<std::size_t>(dataStructure.LoadAsync(identifierPointers.data(), identifierCount, fetcher));
+    reportResult(asyncName, secondsSince(start), identifierPointers.size());
+  }
+  Item::SetItemSource(nullptr);
+}
+
+// Parses the command line; returns false (after printing usage) on an error.
+bool parseSettings(int argumentCount, char** arguments, Settings& settings) {
+  for (int argumentIndex = 1; argumentIndex < argumentCount; ++argumentIndex) {
+    const std::string argument = arguments[argumentIndex];
+    const bool hasValue = argumentIndex + 1 < argumentCount;
+    if (argument == "--colors" && hasValue) {
+      settings.colorsPath = arguments[++argumentIndex];
+    } else if (argument == "--max-items" && hasValue) {
+      settings.maxItemCount = std::strtoull(arguments[++argumentIndex], nullptr, 10);
+    } else if (argument == "--budget" && hasValue) {
+      settings.comparisonBudget = std::strtod(arguments[++argumentIndex], nullptr);
+    } else if (argument == "--filter" && hasValue) {
+      settings.filter = arguments[++argumentIndex];
+    } else {
+      std::cerr << "Usage: " << arguments[0]
+                << " [--colors <path>] [--max-items <n>] [--budget <comparisons>] [--filter <text>]" << std::endl;
+      return false;
+    }
+  }
+  return true;
+}
+
+} // namespace
+
+int main(int argumentCount, char** arguments) {
+  Settings settings;
+  if (!parseSettings(argumentCount, arguments, settings)) {
+    return 1;
+  }
+
+  try {
+    const std::vector<std::string> colorNames = readColorNames(settings.colorsPath);
+    const std::size_t largestItemCount = std::min(settings.maxItemCount, MAX_ITEM_COUNT);
+
+    std::vector<Distribution> distributions;
+    distributions.push_back({"realistic", generateIdentifiers(colorNames, largestItemCount), 0});
+    distributions.push_back({"adversarial", generateIdentifiers({"Cameo Pink"}, largestItemCount), 0});
+
+    DataStructure::Options indexOptions;
+    indexOptions.useIdIndex = true;
+    DataStructure::Options arenaOptions = indexOptions;
+    arenaOptions.useStringArena = true;
+    DataStructure::Options attributeOptions = indexOptions;
+    attributeOptions.useCodeIndex = true;
+    attributeOptions.useTimeIndex = true;
+    // The default node pool against one heap allocation per list node.
+    DataStructure::Options heapNodeOptions = indexOptions;
+    heapNodeOptions.nodeResource = std::pmr::new_delete_resource();
+    DataStructure::Options hashedOptions;
+    hashedOptions.bucketLayout = DataStructure::BucketLayout::HashedArrays;
+    DataStructure::Options hashedIndexOptions = indexOptions;
+    hashedIndexOptions.bucketLayout = DataStructure::BucketLayout::HashedArrays;
+    const Layout layouts[] = {{"plain", DataStructure::Options()},   {"index", indexOptions},
+                              {"index+arena", arenaOptions},         {"index+attributes", attributeOptions},
+                              {"index+heap-nodes", heapNodeOptions}, {"hashed", hashedOptions},
+                              {"hashed+index", hashedIndexOptions}};
+
+    std::printf("%-52s %15s %12s %20s\n", "Benchmark", "Time/op", "Operations", "Throughput");
+    for (std::size_t itemCount = MIN_ITEM_COUNT; itemCount <= largestItemCount; itemCount *= 10) {
+      for (Distribution& distribution : distributions) {
+        const std::vector<std::string> usedIdentifiers(distribution.identifiers.begin(),
+                                                       distribution.identifiers.begin() + static_cast<std::ptrdiff_t>(itemCount));
+        distribution.occupiedListCount = countOccupiedLists(usedIdentifiers);
+        for (const Layout& layout : layouts) {
+          runCase(distribution, layout, itemCount, settings);
+        }
+      }
+    }
+    for (const Distribution& distribution : distributions) {
+      runProviderCases(distribution, settings);
+    }
+  } catch (std::exception& e) {
+    std::cerr << e.what() << std::endl;
+    return 1;
+  }
+  return 0;
+}
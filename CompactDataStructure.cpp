@@ -0,0 +1,144 @@
+#include "CompactDataStructure.h"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <utility>
+
+namespace {
+
+using item_identifier::LETTER_COUNT;
+using item_identifier::ParsedItemIdentifier;
+using item_identifier::tryParseItemIdentifier;
+
+} // namespace
+
+// Copy constructor: copies every list in its original order.
+CompactDataStructure::CompactDataStructure(const CompactDataStructure& original) : mItemCount(original.mItemCount) {
+  for (std::size_t bucketIndex = 0; bucketIndex < LETTER_COUNT; ++bucketIndex) {
+    if (original.mBuckets[bucketIndex]) {
+      mBuckets[bucketIndex] = std::make_unique<Bucket>(*original.mBuckets[bucketIndex]);
+    }
+  }
+}
+
+// Assignment operator: builds the copy first so that a failure leaves *this untouched.
+CompactDataStructure& CompactDataStructure::operator=(const CompactDataStructure& right) {
+  if (this != &right) {
+    CompactDataStructure copy(right);
+    *this = std::move(copy);
+  }
+  return *this;
+}
+
+CompactDataStructure::CompactDataStructure(CompactDataStructure&& source) noexcept
+    : mBuckets(std::move(source.mBuckets)), mItemCount(std::exchange(source.mItemCount, 0)) {}
+
+CompactDataStructure& CompactDataStructure::operator=(CompactDataStructure&& source) noexcept {
+  if (this != &source) {
+    mBuckets = std::move(source.mBuckets);
+    mItemCount = std::exchange(source.mItemCount, 0);
+  }
+  return *this;
+}
+
+void CompactDataStructure::Clear() {
+  for (auto& bucket : mBuckets) {
+    bucket.reset();
+  }
+  mItemCount = 0;
+}
+
+const CompactDataStructure::ItemList* CompactDataStructure::findList(const char* itemIdentifier) const {
+  ParsedItemIdentifier parsedIdentifier;
+  if (!tryParseItemIdentifier(itemIdentifier, parsedIdentifier)) {
+    return nullptr;
+  }
+  const auto& bucket = mBuckets[parsedIdentifier.firstWordIndex];
+  return bucket ? &bucket->lists[parsedIdentifier.secondWordIndex] : nullptr;
+}
+
+// Scans the list of the ID's initials, comparing lengths before characters.
+const CompactItem* CompactDataStructure::GetItem(const char* itemIdentifier) const {
+  const ItemList* itemList = findList(itemIdentifier);
+  if (!itemList) {
+    return nullptr;
+  }
+
+  const std::size_t identifierLength = std::strlen(itemIdentifier);
+  const auto foundItem =
+      std::find_if(itemList->begin(), itemList->end(), [itemIdentifier, identifierLength](const CompactItem& item) {
+        return item.HasID(itemIdentifier, identifierLength);
+      });
+  return foundItem == itemList->end() ? nullptr : &(*foundItem);
+}
+
+// Adds a compact copy of an item to the front of its list.
+// Throws an exception if the ID is invalid or an item with the same ID already exists.
+void CompactDataStructure::operator+=(const ITEM1& itemToAdd) {
+  ParsedItemIdentifier parsedIdentifier;
+  if (!tryParseItemIdentifier(itemToAdd.pID, parsedIdentifier)) {
+    throw std::runtime_error("Invalid ID");
+  }
+
+  if (GetItem(itemToAdd.pID)) {
+    throw std::runtime_error("Item already exists");
+  }
+
+  // A bucket allocated here is released again if the copy throws, so that an
+  // empty bucket is never left behind.
+  auto& bucket = mBuckets[parsedIdentifier.firstWordIndex];
+  const bool isNewBucket = !bucket;
+  if (isNewBucket) {
+    bucket = std::make_unique<Bucket>();
+  }
+  try {
+    bucket->lists[parsedIdentifier.secondWordIndex].emplace_front(itemToAdd);
+  } catch (...) {
+    if (isNewBucket) {
+      bucket.reset();
+    }
+    throw;
+  }
+  ++mItemCount;
+}
+
+// Removes an item by its identifier.
+// Throws an exception if the ID is invalid or the item is not found.
+void CompactDataStructure::operator-=(const char* itemIdentifier) {
+  ParsedItemIdentifier parsedIdentifier;
+  if (!tryParseItemIdentifier(itemIdentifier, parsedIdentifier)) {
+    throw std::runtime_error("Invalid ID");
+  }
+
+  auto& bucket = mBuckets[parsedIdentifier.firstWordIndex];
+  if (!bucket) {
+    throw std::runtime_error("Item not found");
+  }
+
+  const std::size_t identifierLength = std::strlen(itemIdentifier);
+  auto& itemList = bucket->lists[parsedIdentifier.secondWordIndex];
+  for (auto previousIterator = itemList.before_begin(), currentIterator = itemList.begin();
+       currentIterator != itemList.end(); previousIterator = currentIterator++) {
+    if (currentIterator->HasID(itemIdentifier, identifierLength)) {
+      itemList.erase_after(previousIterator);
+      --mItemCount;
+      return;
+    }
+  }
+  throw std::runtime_error("Item not found");
+}
+
+std::ostream& operator<<(std::ostream& outputStream, const CompactDataStructure& dataStructure) {
+  for (const auto& bucket : dataStructure.mBuckets) {
+    if (!bucket) {
+      continue;
+    }
+    for (const auto& itemList : bucket->lists) {
+      for (const CompactItem& currentItem : itemList) {
+        outputStream << currentItem << '\n';
+      }
+    }
+  }
+  return outputStream;
+}
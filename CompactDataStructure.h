@@ -0,0 +1,75 @@
+#pragma once
+
+#include "CompactItem.h"
+#include "ItemIdentifier.h"
+#include "Items.h"
+
+#include <array>
+#include <cstddef>
+#include <forward_list>
+#include <memory>
+#include <ostream>
+
+// =============================================================================
+// CompactDataStructure: The two-level layout of DataStructure for CompactItem.
+//
+// Items are organised exactly as in DataStructure (26 lazily allocated
+// buckets by first-word initial, each with 26 lists by second-word initial),
+// but every list node holds a CompactItem. A typical item therefore costs a
+// single heap block instead of three, and a list scan compares IDs stored in
+// the nodes it walks.
+//
+// Items are added from any ITEM1 (an Item, a provider record or a
+// CompactItem::View) and are read back as CompactItem; use
+// CompactItem::GetView() or ToItem() where an ITEM1 or Item is needed.
+// =============================================================================
+class CompactDataStructure
+{
+public:
+  CompactDataStructure() = default;
+  ~CompactDataStructure() = default;
+
+  CompactDataStructure(const CompactDataStructure& original);
+  CompactDataStructure& operator=(const CompactDataStructure& right);
+
+  // Move constructor and assignment: take over the buckets of the source,
+  // which is left empty.
+  CompactDataStructure(CompactDataStructure&& source) noexcept;
+  CompactDataStructure& operator=(CompactDataStructure&& source) noexcept;
+
+  // Removes all items and releases the buckets.
+  void Clear();
+
+  // Returns the total number of items. Runs in constant time.
+  int GetItemsNumber() const { return mItemCount; }
+
+  // Searches for an item by its ID string (e.g., "Cafe Noir").
+  // Returns a pointer to the item if found, or nullptr if not found.
+  const CompactItem* GetItem(const char* pID) const;
+
+  // Adds a compact copy of an item.
+  // Throws std::runtime_error if the ID is invalid, the item already
+  // exists or its time is not formatted as hh:mm:ss.
+  void operator+=(const ITEM1& item);
+
+  // Removes an item by its ID string.
+  // Throws std::runtime_error if the ID is invalid or item not found.
+  void operator-=(const char* pID);
+
+  // Prints all items, one per line.
+  friend std::ostream& operator<<(std::ostream& ostr, const CompactDataStructure& str);
+
+private:
+  using ItemList = std::forward_list<CompactItem>;
+
+  struct Bucket {
+    std::array<ItemList, item_identifier::LETTER_COUNT> lists;
+  };
+
+  // Returns the list an ID belongs to, or nullptr if the ID is invalid or
+  // its bucket has not been allocated.
+  const ItemList* findList(const char* pID) const;
+
+  std::array<std::unique_ptr<Bucket>, item_identifier::LETTER_COUNT> mBuckets;
+  int mItemCount = 0;
+};
@@ -0,0 +1,116 @@
+#include "CompactItem.h"
+
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+
+namespace {
+
+// Converts "hh:mm:ss" into seconds since midnight.
+// Throws std::runtime_error for any other format.
+std::uint32_t parseTime(const char* timeText) {
+  std::uint32_t secondsOfDay;
+  if (!item_time::tryPackTime(timeText, secondsOfDay)) {
+    throw std::runtime_error("Invalid time");
+  }
+  return secondsOfDay;
+}
+
+} // namespace
+
+// The view borrows the item's ID and formats the packed time into its own buffer.
+CompactItem::View::View(const CompactItem& item) : ITEM1() {
+  item.FormatTime(mTimeText);
+  pID = const_cast<char*>(item.GetID());
+  Code = item.GetCode();
+  pTime = mTimeText;
+  pNext = nullptr;
+}
+
+// Validates and packs the time first, so that nothing is allocated on failure.
+CompactItem::CompactItem(const ITEM1& source) : mCode(source.Code), mSecondsOfDay(parseTime(source.pTime)) {
+  if (!source.pID) {
+    throw std::runtime_error("Invalid ID");
+  }
+  assignID(source.pID, std::strlen(source.pID));
+}
+
+CompactItem::~CompactItem() {
+  releaseID();
+}
+
+CompactItem::CompactItem(const CompactItem& orig) : mCode(orig.mCode), mSecondsOfDay(orig.mSecondsOfDay) {
+  assignID(orig.GetID(), orig.mIdLength);
+}
+
+// Builds the new ID before releasing the old one, so a failure leaves *this unchanged.
+CompactItem& CompactItem::operator=(const CompactItem& right) {
+  if (this != &right) {
+    CompactItem copy(right);
+    *this = std::move(copy);
+  }
+  return *this;
+}
+
+CompactItem::CompactItem(CompactItem&& orig) noexcept
+    : mCode(orig.mCode), mSecondsOfDay(orig.mSecondsOfDay), mIdLength(orig.mIdLength), mId(orig.mId) {
+  orig.mIdLength = 0;
+  orig.mId.inlineText[0] = '\0';
+}
+
+CompactItem& CompactItem::operator=(CompactItem&& right) noexcept {
+  if (this != &right) {
+    releaseID();
+    mCode = right.mCode;
+    mSecondsOfDay = right.mSecondsOfDay;
+    mIdLength = right.mIdLength;
+    mId = right.mId;
+    right.mIdLength = 0;
+    right.mId.inlineText[0] = '\0';
+  }
+  return *this;
+}
+
+// Short IDs go into the inline buffer, longer ones into a heap block of their own.
+void CompactItem::assignID(const char* pID, std::size_t idLength) {
+  if (idLength > std::numeric_limits<std::uint32_t>::max()) {
+    throw std::runtime_error("Invalid ID");
+  }
+  char* idText = mId.inlineText;
+  if (idLength > INLINE_ID_CAPACITY) {
+    idText = new char[idLength + 1];
+    mId.heapText = idText;
+  }
+  std::memcpy(idText, pID, idLength);
+  idText[idLength] = '\0';
+  mIdLength = static_cast<std::uint32_t>(idLength);
+}
+
+void CompactItem::releaseID() {
+  if (!isInline()) {
+    delete[] mId.heapText;
+  }
+}
+
+void CompactItem::FormatTime(char (&timeText)[TIME_TEXT_SIZE]) const {
+  item_time::formatTime(mSecondsOfDay, timeText);
+}
+
+// The length check rejects most non-matching IDs without touching their text.
+bool CompactItem::HasID(const char* pID, std::size_t idLength) const {
+  return mIdLength == idLength && std::memcmp(GetID(), pID, idLength) == 0;
+}
+
+// Copies the item into a plain Item through its ITEM1 view.
+Item CompactItem::ToItem() const {
+  const View view(*this);
+  return Item(static_cast<const ITEM1&>(view));
+}
+
+bool CompactItem::operator==(const CompactItem& other) const {
+  return other.HasID(GetID(), mIdLength);
+}
+
+std::ostream& operator<<(std::ostream& outputStream, const CompactItem& itemToOutput) {
+  return outputStream.write(itemToOutput.GetID(), static_cast<std::streamsize>(itemToOutput.GetIDLength()));
+}
@@ -0,0 +1,112 @@
+#pragma once
+
+#include "Item.h"
+#include "ItemTime.h"
+#include "Items.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+
+// =============================================================================
+// CompactItem: A single-block storage layout for the data of an ITEM1.
+//
+// An Item keeps its ID and time in two separate heap blocks and carries the
+// pNext pointer of ITEM1, which a container never uses. CompactItem instead
+// stores
+// - the ID inline if it has at most INLINE_ID_CAPACITY characters (most of
+//   the Colors.txt names), and in one heap block only if it is longer
+// - the "hh:mm:ss" time packed into the number of seconds since midnight
+// - the ID length, so that comparisons can reject most IDs on the length
+//
+// A CompactItem inside a list node therefore costs one allocation, and
+// scanning a list reads the IDs from the nodes themselves instead of
+// following a pointer per item.
+//
+// Callers that need an ITEM1 can get one from GetView() (borrowing the ID)
+// or ToItem() (a stand-alone copy).
+// =============================================================================
+class CompactItem
+{
+public:
+  // Longest ID that is stored without a separate heap block.
+  static constexpr std::size_t INLINE_ID_CAPACITY = 23;
+
+  // Size of a formatted time including the terminating NUL ("hh:mm:ss").
+  static constexpr std::size_t TIME_TEXT_SIZE = item_time::TIME_TEXT_SIZE;
+
+  // ITEM1 whose pID points into a CompactItem and whose pTime points into the
+  // view itself. It is valid as long as the item is neither changed nor
+  // destroyed, must not be modified, and cannot be copied (pTime would
+  // dangle); pNext is always nullptr.
+  class View : public ITEM1
+  {
+  public:
+    explicit View(const CompactItem& item);
+    View(const View&) = delete;
+    View& operator=(const View&) = delete;
+
+  private:
+    char mTimeText[TIME_TEXT_SIZE];
+  };
+
+  // Copies the ID, Code and time of source.
+  // Throws std::runtime_error if pID is nullptr or pTime is not "hh:mm:ss".
+  explicit CompactItem(const ITEM1& source);
+
+  ~CompactItem();
+
+  CompactItem(const CompactItem& orig);
+  CompactItem& operator=(const CompactItem& right);
+
+  // Takes over the heap block of a long ID; the source is left with an
+  // empty ID.
+  CompactItem(CompactItem&& orig) noexcept;
+  CompactItem& operator=(CompactItem&& right) noexcept;
+
+  // Returns the NUL-terminated ID.
+  const char* GetID() const { return isInline() ? mId.inlineText : mId.heapText; }
+
+  // Returns the number of characters in the ID.
+  std::size_t GetIDLength() const { return mIdLength; }
+
+  unsigned long GetCode() const { return mCode; }
+
+  // Returns the time as the number of seconds since midnight.
+  std::uint32_t GetSecondsOfDay() const { return mSecondsOfDay; }
+
+  // Writes the time as "hh:mm:ss" (with the terminating NUL) into timeText.
+  void FormatTime(char (&timeText)[TIME_TEXT_SIZE]) const;
+
+  // True if the ID equals the first idLength characters of pID.
+  bool HasID(const char* pID, std::size_t idLength) const;
+
+  // Returns an ITEM1 view of this item; see View.
+  View GetView() const { return View(*this); }
+
+  // Returns a stand-alone Item with copies of the ID and time.
+  Item ToItem() const;
+
+  // Two items are equal if they have the same ID string.
+  bool operator==(const CompactItem& other) const;
+
+  // Prints the item's ID.
+  friend std::ostream& operator<<(std::ostream& ostr, const CompactItem& it);
+
+private:
+  bool isInline() const { return mIdLength <= INLINE_ID_CAPACITY; }
+
+  // Copies idLength characters of pID into the inline buffer or a new heap block.
+  void assignID(const char* pID, std::size_t idLength);
+
+  // Frees the heap block of a long ID.
+  void releaseID();
+
+  unsigned long mCode = 0;
+  std::uint32_t mSecondsOfDay = 0;
+  std::uint32_t mIdLength = 0;
+  union {
+    char inlineText[INLINE_ID_CAPACITY + 1];
+    char* heapText;
+  } mId;
+};
@@ -0,0 +1,103 @@
+#include "ConcurrentDataStructure.h"
+
+#include <stdexcept>
+#include <utility>
+
+// Creates the partitions with the given settings.
+ConcurrentDataStructure::ConcurrentDataStructure(const DataStructure::Options& options) {
+  for (Partition& partition : mPartitions) {
+    partition.items = DataStructure(options);
+  }
+}
+
+// Maps the first letter of an ID to its partition.
+const ConcurrentDataStructure::Partition* ConcurrentDataStructure::findPartition(const char* itemIdentifier) const {
+  if (!itemIdentifier || itemIdentifier[0] < 'A' || itemIdentifier[0] > 'Z') {
+    return nullptr;
+  }
+  return &mPartitions[static_cast<std::size_t>(itemIdentifier[0] - 'A')];
+}
+
+ConcurrentDataStructure::Partition* ConcurrentDataStructure::findPartition(const char* itemIdentifier) {
+  return const_cast<Partition*>(std::as_const(*this).findPartition(itemIdentifier));
+}
+
+ConcurrentDataStructure::Partition& ConcurrentDataStructure::getPartition(const char* itemIdentifier) {
+  Partition* partition = findPartition(itemIdentifier);
+  if (!partition) {
+    throw std::runtime_error("Invalid ID");
+  }
+  return *partition;
+}
+
+// Reads the count of one partition under its shared lock.
+int ConcurrentDataStructure::GetBucketItemsNumber(char firstWordInitial) const {
+  const char itemIdentifier[] = {firstWordInitial, '\0'};
+  const Partition* partition = findPartition(itemIdentifier);
+  if (!partition) {
+    return 0;
+  }
+  std::shared_lock<std::shared_mutex> lock(partition->mutex);
+  return partition->items.GetItemsNumber();
+}
+
+// Copies the item out while its partition is locked for reading.
+bool ConcurrentDataStructure::CopyItem(char* itemIdentifier, Item& result) const {
+  return ReadItem(itemIdentifier, [&result](const Item& foundItem) { result = foundItem; });
+}
+
+// Adds a copy of the item under the exclusive lock of its partition.
+void ConcurrentDataStructure::operator+=(Item& itemToAdd) {
+  Partition& partition = getPartition(itemToAdd.GetID());
+  std::unique_lock<std::shared_mutex> lock(partition.mutex);
+  partition.items += itemToAdd;
+  mItemCount.fetch_add(1, std::memory_order_relaxed);
+}
+
+// Moves the item in under the exclusive lock of its partition.
+void ConcurrentDataStructure::operator+=(Item&& itemToAdd) {
+  Partition& partition = getPartition(itemToAdd.GetID());
+  std::unique_lock<std::shared_mutex> lock(partition.mutex);
+  partition.items += std::move(itemToAdd);
+  mItemCount.fetch_add(1, std::memory_order_relaxed);
+}
+
+// Checks for a duplicate under the shared lock, fetches the item without any
+// lock held, and inserts it under the exclusive lock. operator+= repeats the
+// duplicate check, which catches an item added by another thread meanwhile.
+void ConcurrentDataStructure::Emplace(char* itemIdentifier) {
+  Partition& partition = getPartition(itemIdentifier);
+  {
+    std::shared_lock<std::shared_mutex> lock(partition.mutex);
+    if (partition.items.GetItem(itemIdentifier)) {
+      throw std::runtime_error("Item already exists");
+    }
+  }
+  *this += Item(itemIdentifier);
+}
+
+// Removes the item under the exclusive lock of its partition.
+void ConcurrentDataStructure::operator-=(char* itemIdentifier) {
+  Partition& partition = getPartition(itemIdentifier);
+  std::unique_lock<std::shared_mutex> lock(partition.mutex);
+  partition.items -= itemIdentifier;
+  mItemCount.fetch_sub(1, std::memory_order_relaxed);
+}
+
+// Clears the partitions one after another.
+void ConcurrentDataStructure::Clear() {
+  for (Partition& partition : mPartitions) {
+    std::unique_lock<std::shared_mutex> lock(partition.mutex);
+    mItemCount.fetch_sub(partition.items.GetItemsNumber(), std::memory_order_relaxed);
+    partition.items.Clear();
+  }
+}
+
+// Stream output operator: prints the partitions in letter order, one per line.
+std::ostream& operator<<(std::ostream& outputStream, const ConcurrentDataStructure& dataStructure) {
+  for (const auto& partition : dataStructure.mPartitions) {
+    std::shared_lock<std::shared_mutex> lock(partition.mutex);
+    outputStream << partition.items;
+  }
+  return outputStream;
+}
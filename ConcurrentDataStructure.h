@@ -0,0 +1,117 @@
+#pragma once
+
+#include "DataStructure.h"
+#include "Item.h"
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <mutex>
+#include <ostream>
+#include <shared_mutex>
+
+// =============================================================================
+// ConcurrentDataStructure: A thread-safe variant of DataStructure.
+//
+// The items are split by the first letter of their ID into 26 partitions,
+// each holding a DataStructure for that letter and its own shared_mutex:
+// - Lookups take the partition's lock in shared mode, so readers never
+//   block each other, and readers of different letters never even touch
+//   the same lock.
+// - operator+=, Emplace and operator-= take only the lock of the partition
+//   they modify, in exclusive mode.
+//
+// Items are returned by copy (CopyItem) or passed to a callback while the
+// partition is locked (ReadItem); a raw pointer could be invalidated by a
+// concurrent operator-= as soon as the lock is released.
+//
+// DataStructure::Options apply to every partition.
+// =============================================================================
+class ConcurrentDataStructure
+{
+public:
+  ConcurrentDataStructure() = default;
+  ~ConcurrentDataStructure() = default;
+
+  // Creates an empty data structure whose partitions use the given settings.
+  explicit ConcurrentDataStructure(const DataStructure::Options& options);
+
+  // The per-partition mutexes can be neither copied nor moved.
+  ConcurrentDataStructure(const ConcurrentDataStructure&) = delete;
+  ConcurrentDataStructure& operator=(const ConcurrentDataStructure&) = delete;
+
+  // Returns the total number of items. Runs in constant time without locking;
+  // with concurrent writers the result may already be outdated.
+  int GetItemsNumber() const { return mItemCount.load(std::memory_order_relaxed); }
+
+  // Returns the number of items whose ID starts with firstWordInitial,
+  // or 0 if the letter is not in A-Z.
+  int GetBucketItemsNumber(char firstWordInitial) const;
+
+  // Searches for an item by its ID string. If found, copies it into result
+  // and returns true; otherwise returns false and leaves result unchanged.
+  bool CopyItem(char *pID, Item& result) const;
+
+  // Searches for an item by its ID string. If found, calls reader(const Item&)
+  // while the item's partition is locked for reading and returns true.
+  // reader must not modify this data structure.
+  template <typename TReader>
+  bool ReadItem(char *pID, TReader&& reader) const {
+    const Partition* partition = findPartition(pID);
+    if (!partition) {
+      return false;
+    }
+    std::shared_lock<std::shared_mutex> lock(partition->mutex);
+    const Item* foundItem = partition->items.GetItem(pID);
+    if (!foundItem) {
+      return false;
+    }
+    reader(*foundItem);
+    return true;
+  }
+
+  // Adds a copy of an item to the data structure.
+  // Throws std::runtime_error if the ID is invalid or item already exists.
+  void operator+=(Item& item);
+
+  // Adds an item to the data structure, taking over its strings.
+  // Throws std::runtime_error if the ID is invalid or item already exists.
+  void operator+=(Item&& item);
+
+  // Fetches the item with the given ID from the data provider and adds it.
+  // The provider is called without holding any lock.
+  // Throws std::runtime_error if the ID is invalid or item already exists.
+  void Emplace(char *pID);
+
+  // Removes an item by its ID string.
+  // Throws std::runtime_error if the ID is invalid or item not found.
+  void operator-=(char *pID);
+
+  // Removes all items, locking one partition at a time.
+  void Clear();
+
+  // Prints all items, locking one partition at a time for reading.
+  friend std::ostream &operator<<(std::ostream &ostr, const ConcurrentDataStructure &str);
+
+private:
+  static constexpr std::size_t LETTER_COUNT = 26;
+
+  // Items with one first-word initial and the lock guarding them.
+  // Aligned to a cache line so that neighbouring locks do not share one.
+  struct alignas(64) Partition {
+    mutable std::shared_mutex mutex;
+    DataStructure items;
+  };
+
+  // Returns the partition for the first letter of pID,
+  // or nullptr if pID is null or does not start with A-Z.
+  const Partition* findPartition(const char* pID) const;
+  Partition* findPartition(const char* pID);
+
+  // Same as findPartition, but throws std::runtime_error("Invalid ID")
+  // instead of returning nullptr.
+  Partition& getPartition(const char* pID);
+
+  std::array<Partition, LETTER_COUNT> mPartitions;
+  std::atomic<int> mItemCount{0};
+};
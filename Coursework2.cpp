@@ -1,17 +1,79 @@
-#include "DataProvider.h"
 #include "Item.h"
+#include "ItemSource.h"
+#include "ProviderCache.h"
+#include "StringArena.h"
 
+#include <atomic>
 #include <cstring>
+#include <memory>
 #include <stdexcept>
+#include <string>
+#include <utility>
 
 namespace {
-  // Fetches an item from the external data provider library.
-  // If itemIdentifier is nullptr, a random item is returned.
-  ITEM1* fetchItemFromProvider(char* itemIdentifier) {
-    ITEM1* fetchedItem = static_cast<ITEM1*>(GetItem(1, itemIdentifier));
+  // ID and time strings of one fetched item, allocated with new[].
+  // Frees them on destruction unless they were taken over (set to nullptr).
+  struct FetchedItem {
+    char* pID = nullptr;
+    unsigned long Code = 0;
+    char* pTime = nullptr;
+
+    FetchedItem() = default;
+    FetchedItem(const FetchedItem&) = delete;
+    FetchedItem& operator=(const FetchedItem&) = delete;
+    ~FetchedItem() {
+      delete[] pID;
+      delete[] pTime;
+      }
+    };
+
+  // Cache of provider results shared by all ID-based Item constructors.
+  ProviderCache& providerCache() {
+    static ProviderCache cache;
+    return cache;
+    }
+
+  // Calls of fetchItemFromProvider, timed around the item source call.
+  instrumentation::OperationRecorder& providerCallRecorder() {
+    static instrumentation::OperationRecorder recorder;
+    return recorder;
+    }
+
+  // Item source plugged in by Item::SetItemSource; nullptr selects the
+  // external data provider library.
+  std::atomic<ItemSource*>& pluggedItemSource() {
+    static std::atomic<ItemSource*> source{nullptr};
+    return source;
+    }
+
+  // Hands an item back to the item source it was fetched from.
+  struct SourceItemRelease {
+    ItemSource* source = nullptr;
+
+    void operator()(ITEM1* sourceItem) const {
+      source->Release(sourceItem);
+      }
+    };
+
+  using SourceItemPointer = std::unique_ptr<ITEM1, SourceItemRelease>;
+
+  // Fetches an item from the current item source, by default the external
+  // data provider library. If itemIdentifier is nullptr, a random item is
+  // returned. The item goes back to its source (see ItemSource::Release)
+  // when the pointer is destroyed; the data provider's items are never
+  // freed, since its DLL allocates them on another C runtime's heap.
+  SourceItemPointer fetchItemFromProvider(char* itemIdentifier) {
+    static ProviderItemSource dataProvider;
+    ItemSource* source = pluggedItemSource().load(std::memory_order_acquire);
+    if (!source) {
+      source = &dataProvider;
+      }
+    instrumentation::OperationScope providerCall(providerCallRecorder());
+    SourceItemPointer fetchedItem(source->FetchItem(itemIdentifier), SourceItemRelease{source});
     if (!fetchedItem || !fetchedItem->pID) {
       throw std::runtime_error("Failed to retrieve item from provider");
       }
+    providerCall.Succeed();
     return fetchedItem;
     }
 
@@ -26,56 +88,185 @@ namespace {
     strcpy_s(copy, length, source);
     return copy;
     }
+
+  // Duplicates the ID and time strings of an item into idCopy and timeCopy.
+  // If the second copy throws, the first is freed again before rethrowing.
+  void duplicateStrings(const char* sourceID, const char* sourceTime, char*& idCopy, char*& timeCopy) {
+    char* newID = duplicateString(sourceID);
+    try {
+      timeCopy = duplicateString(sourceTime);
+      }
+    catch (...) {
+      delete[] newID;
+      throw;
+      }
+    idCopy = newID;
+    }
+
+  // Fetches the item with the given identifier into result, answering from
+  // the provider cache when possible. If itemIdentifier is nullptr, a random
+  // item is fetched and the cache is bypassed.
+  void fetchItem(char* itemIdentifier, FetchedItem& result) {
+    std::string cachedTime;
+    if (itemIdentifier && providerCache().Find(itemIdentifier, result.Code, cachedTime)) {
+      result.pID = duplicateString(itemIdentifier);
+      result.pTime = duplicateString(cachedTime.c_str());
+      return;
+      }
+
+    const SourceItemPointer providerItem = fetchItemFromProvider(itemIdentifier);
+    if (itemIdentifier) {
+      providerCache().Insert(*providerItem);
+      }
+    result.pID = duplicateString(providerItem->pID);
+    result.Code = providerItem->Code;
+    result.pTime = duplicateString(providerItem->pTime);
+    }
   } // namespace
 
 // Default constructor: fetches a random item from the data provider.
-Item::Item() {
-  ITEM1* fetchedItem = fetchItemFromProvider(nullptr);
-  pID = duplicateString(fetchedItem->pID);
-  Code = fetchedItem->Code;
-  pTime = duplicateString(fetchedItem->pTime);
-  pNext = nullptr;
-  }
+Item::Item() : Item(nullptr) {}
 
 // Parameterized constructor: fetches an item with the given identifier.
 // If itemIdentifier is nullptr, a random item is fetched.
 Item::Item(char* itemIdentifier) {
-  ITEM1* fetchedItem = fetchItemFromProvider(itemIdentifier);
-  pID = duplicateString(fetchedItem->pID);
-  Code = fetchedItem->Code;
-  pTime = duplicateString(fetchedItem->pTime);
+  FetchedItem fetchedItem;
+  fetchItem(itemIdentifier, fetchedItem);
+  pID = std::exchange(fetchedItem.pID, nullptr);
+  Code = fetchedItem.Code;
+  pTime = std::exchange(fetchedItem.pTime, nullptr);
   pNext = nullptr;
   }
 
+// Arena constructor: fetches an item with the given identifier and copies
+// its strings into arena instead of separate heap blocks.
+Item::Item(char* itemIdentifier, StringArena& arena) {
+  FetchedItem fetchedItem;
+  fetchItem(itemIdentifier, fetchedItem);
+  pID = arena.Duplicate(fetchedItem.pID);
+  Code = fetchedItem.Code;
+  pTime = arena.Duplicate(fetchedItem.pTime);
+  pNext = nullptr;
+  mOwnsStrings = false;
+  }
+
+// Switches the source of the ID-based constructors. Cached results of the
+// previous source would no longer match, so the cache is emptied.
+void Item::SetItemSource(ItemSource* source) {
+  pluggedItemSource().store(source, std::memory_order_release);
+  providerCache().Clear();
+  }
+
+// Limits the provider cache; 0 disables it.
+void Item::SetProviderCacheCapacity(std::size_t capacity) {
+  providerCache().SetCapacity(capacity);
+  }
+
+// Returns the hit/miss counters and the fill level of the provider cache.
+ProviderCacheStats Item::GetProviderCacheStats() {
+  return providerCache().GetStats();
+  }
+
+// Drops all cached provider results.
+void Item::ClearProviderCache() {
+  providerCache().Clear();
+  }
+
+// Returns the call counters and latencies of the item source.
+instrumentation::OperationStats Item::GetProviderCallStats() {
+  return providerCallRecorder().Snapshot();
+  }
+
 // Destructor: frees the dynamically allocated ID and time strings.
+// Strings placed in an arena are left to the arena.
 Item::~Item() {
-  delete[] pID;
-  delete[] pTime;
+  if (mOwnsStrings) {
+    delete[] pID;
+    delete[] pTime;
+    }
   pNext = nullptr;
   }
 
 // Copy constructor: creates a deep copy of the sourceItem.
 Item::Item(const Item& sourceItem) {
-  pID = duplicateString(sourceItem.pID);
+  duplicateStrings(sourceItem.pID, sourceItem.pTime, pID, pTime);
+  Code = sourceItem.Code;
+  pNext = nullptr;
+  }
+
+// Raw copy constructor: creates a deep copy of a plain ITEM1 record.
+Item::Item(const ITEM1& sourceItem) {
+  duplicateStrings(sourceItem.pID, sourceItem.pTime, pID, pTime);
   Code = sourceItem.Code;
-  pTime = duplicateString(sourceItem.pTime);
   pNext = nullptr;
   }
 
+// Arena copy constructor: copies sourceItem with its strings placed in arena.
+Item::Item(const ITEM1& sourceItem, StringArena& arena) {
+  pID = arena.Duplicate(sourceItem.pID);
+  Code = sourceItem.Code;
+  pTime = arena.Duplicate(sourceItem.pTime);
+  pNext = nullptr;
+  mOwnsStrings = false;
+  }
+
 // Assignment operator: performs a deep copy of otherItem.
 // Uses copy-and-swap idiom to ensure exception safety.
 Item& Item::operator=(const Item& otherItem) {
   if (this != &otherItem) {
-    char* newID = duplicateString(otherItem.pID);
-    char* newTime = duplicateString(otherItem.pTime);
+    char* newID;
+    char* newTime;
+    duplicateStrings(otherItem.pID, otherItem.pTime, newID, newTime);
 
-    delete[] pID;
-    delete[] pTime;
+    if (mOwnsStrings) {
+      delete[] pID;
+      delete[] pTime;
+      }
 
     pID = newID;
     pTime = newTime;
     Code = otherItem.Code;
     pNext = nullptr;
+    mOwnsStrings = true;
+    }
+  return *this;
+  }
+
+// Move constructor: steals the strings of sourceItem and leaves it empty.
+// Arena-backed strings are not owned by sourceItem, so they are copied.
+Item::Item(Item&& sourceItem) {
+  Code = sourceItem.Code;
+  pNext = nullptr;
+  if (sourceItem.mOwnsStrings) {
+    pID = sourceItem.pID;
+    pTime = sourceItem.pTime;
+    sourceItem.pID = nullptr;
+    sourceItem.pTime = nullptr;
+  } else {
+    duplicateStrings(sourceItem.pID, sourceItem.pTime, pID, pTime);
+    }
+  }
+
+// Move assignment operator: frees the current strings and steals those of
+// otherItem. Arena-backed strings are copied, as in the move constructor.
+Item& Item::operator=(Item&& otherItem) {
+  if (this != &otherItem) {
+    if (!otherItem.mOwnsStrings) {
+      return *this = otherItem;
+      }
+
+    if (mOwnsStrings) {
+      delete[] pID;
+      delete[] pTime;
+      }
+
+    pID = otherItem.pID;
+    pTime = otherItem.pTime;
+    Code = otherItem.Code;
+    pNext = nullptr;
+    mOwnsStrings = true;
+    otherItem.pID = nullptr;
+    otherItem.pTime = nullptr;
     }
   return *this;
   }
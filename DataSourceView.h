@@ -0,0 +1,132 @@
+#pragma once
+
+#include "Headers.h"
+#include "Items.h"
+
+#include <cstring>
+
+// =============================================================================
+// DataSourceView: A read-only, zero-copy view of a structure built by
+// DataSource.dll (GetStruct1, GetStruct2, GetStruct4, GetStruct5).
+//
+// These structures already use the same two-level layout as DataStructure:
+// a linked list of first-level headers, one per first letter of the first
+// word, each leading to the items grouped by the first letter of the second
+// word. They differ only in how that second level is stored:
+// - HEADER_B (GetStruct1), HEADER_D (GetStruct4):
+//       pHeaderA -> linked list of HEADER_A, one per second-word initial,
+//       each with a linked list of items in pItems
+// - HEADER_C (GetStruct2), HEADER_E (GetStruct5):
+//       ppItems -> array of 26 linked lists of items, indexed by the
+//       second-word initial (A=0, B=1, ... Z=25)
+//
+// The view works directly on the provider's memory: lookups, counting and
+// iteration never copy an item. It does not own the structure, which must
+// stay alive and unchanged while the view is used.
+//
+// The items are expected to be of type ITEM1, as produced by GetStructN(1, ...).
+// =============================================================================
+
+namespace data_source_view_detail {
+
+// Returns the item list for secondWordInitial from a HEADER_A chain.
+inline ITEM1* findItemList(const HEADER_A* secondLevelHeader, char secondWordInitial) {
+  for (; secondLevelHeader; secondLevelHeader = secondLevelHeader->pNext) {
+    if (secondLevelHeader->cBegin == secondWordInitial) {
+      return static_cast<ITEM1*>(secondLevelHeader->pItems);
+    }
+  }
+  return nullptr;
+}
+
+// Returns the item list for secondWordInitial from a 26-entry array of lists.
+inline ITEM1* findItemList(void* const* itemLists, char secondWordInitial) {
+  return itemLists ? static_cast<ITEM1*>(itemLists[secondWordInitial - 'A']) : nullptr;
+}
+
+// Calls visit(list) for every item list of a HEADER_A chain.
+template <typename TVisitor>
+void forEachItemList(const HEADER_A* secondLevelHeader, TVisitor& visit) {
+  for (; secondLevelHeader; secondLevelHeader = secondLevelHeader->pNext) {
+    visit(static_cast<ITEM1*>(secondLevelHeader->pItems));
+  }
+}
+
+// Calls visit(list) for every item list of a 26-entry array of lists.
+template <typename TVisitor>
+void forEachItemList(void* const* itemLists, TVisitor& visit) {
+  if (!itemLists) {
+    return;
+  }
+  for (int listIndex = 0; listIndex < 26; ++listIndex) {
+    visit(static_cast<ITEM1*>(itemLists[listIndex]));
+  }
+}
+
+// Second level of each first-level header type.
+inline const HEADER_A* secondLevelOf(const HEADER_B* header) { return header->pHeaderA; }
+inline const HEADER_A* secondLevelOf(const HEADER_D* header) { return header->pHeaderA; }
+inline void* const* secondLevelOf(const HEADER_C* header) { return header->ppItems; }
+inline void* const* secondLevelOf(const HEADER_E* header) { return header->ppItems; }
+
+} // namespace data_source_view_detail
+
+template <typename THeader>
+class DataSourceView
+{
+public:
+  // Creates a view of the structure whose first header is pStructure.
+  // pStructure may be nullptr, which gives an empty view.
+  explicit DataSourceView(THeader* pStructure) : mStructure(pStructure) {}
+
+  // Searches for an item by its ID string (e.g., "Cafe Noir").
+  // Returns a pointer into the provider's structure, or nullptr if not found.
+  ITEM1* GetItem(const char* pID) const {
+    if (!pID || pID[0] < 'A' || pID[0] > 'Z') {
+      return nullptr;
+    }
+    const char* spacePosition = std::strchr(pID, ' ');
+    if (!spacePosition || spacePosition[1] < 'A' || spacePosition[1] > 'Z') {
+      return nullptr;
+    }
+
+    for (const THeader* header = mStructure; header; header = header->pNext) {
+      if (header->cBegin != pID[0]) {
+        continue;
+      }
+      ITEM1* currentItem = data_source_view_detail::findItemList(
+          data_source_view_detail::secondLevelOf(header), spacePosition[1]);
+      for (; currentItem; currentItem = currentItem->pNext) {
+        if (std::strcmp(currentItem->pID, pID) == 0) {
+          return currentItem;
+        }
+      }
+      return nullptr;
+    }
+    return nullptr;
+  }
+
+  // Returns the number of items in the structure. Walks all item lists.
+  int GetItemsNumber() const {
+    int totalCount = 0;
+    ForEach([&totalCount](const ITEM1&) { ++totalCount; });
+    return totalCount;
+  }
+
+  // Calls visit(const ITEM1&) for every item, in the order of the
+  // provider's headers and lists.
+  template <typename TVisitor>
+  void ForEach(TVisitor visit) const {
+    auto visitList = [&visit](const ITEM1* currentItem) {
+      for (; currentItem; currentItem = currentItem->pNext) {
+        visit(*currentItem);
+      }
+    };
+    for (const THeader* header = mStructure; header; header = header->pNext) {
+      data_source_view_detail::forEachItemList(data_source_view_detail::secondLevelOf(header), visitList);
+    }
+  }
+
+private:
+  THeader* mStructure;
+};
@@ -1,128 +1,1486 @@
 #include "DataStructure.h"
+#include "AsyncItemFetcher.h"
+#include "DataSource.h"
+#include "DataStructureSnapshot.h"
+#include "FingerprintScan.h"
+#include "ItemIdentifier.h"
+#include "ItemTime.h"
+#include "MemoryPrefetch.h"
 
 #include <algorithm>
+#include <atomic>
+#include <charconv>
+#include <condition_variable>
+#include <deque>
+#include <cstdint>
 #include <cstring>
-#include <iterator>
+#include <exception>
+#include <fstream>
+#include <limits>
+#include <mutex>
+#include <new>
 #include <stdexcept>
+#include <system_error>
+#include <thread>
+#include <utility>
+#include <vector>
 
 // =============================================================================
 // This file implements a two-level hash-like data structure for storing Items.
 //
 // The storage works like this:
 // - Items are indexed by their ID string, which has the format "FirstWord SecondWord"
-// - The first level is a map keyed by the first letter of the first word (A-Z)
+// - The first level is a flat table of 26 bucket pointers, indexed by the first
+//   letter of the first word (A=0, B=1, ... Z=25); buckets are allocated lazily
 // - The second level is an array of 26 linked lists, indexed by the first letter
 //   of the second word (A=0, B=1, ... Z=25)
 //
 // Example: "Cafe Noir" would be stored at:
-//   mBuckets['C'][13]  (C for "Cafe", 13 for 'N' in "Noir")
+//   linkedListOf(*mBuckets[2], 13)  (2 for 'C' in "Cafe", 13 for 'N' in "Noir")
 // =============================================================================
 
 namespace {
 
-// Constants for valid uppercase letter range (A-Z)
-constexpr char FIRST_VALID_LETTER = 'A';
-constexpr char LAST_VALID_LETTER = 'Z';
-constexpr char WORD_SEPARATOR = ' ';
+using item_identifier::identifierEquals;
+using item_identifier::ParsedItemIdentifier;
+using item_identifier::tryGetLetterIndex;
+using item_identifier::tryParseItemIdentifier;
 
-// Holds the parsed components of an item identifier.
-// The identifier format is "FirstWord SecondWord" (e.g., "Cafe Noir").
-struct ParsedItemIdentifier {
-  char firstWordInitial{};       // First letter of the first word (e.g., 'C' for "Cafe")
-  std::size_t secondWordIndex{}; // Index derived from first letter of second word (0-25)
-};
+// Makes sure that one more element can be appended to values without
+// throwing, growing the capacity geometrically like push_back would.
+template <typename Value>
+void reserveForOneMore(std::vector<Value>& values) {
+  if (values.size() == values.capacity()) {
+    values.reserve(std::max<std::size_t>(4, values.capacity() * 2));
+  }
+}
+
+// Formatting of one item for DataStructure::Export. Every format is written
+// in two steps, so that the space for an item can be made available before
+// it is formatted in place: formattedLength() returns the number of
+// characters and formatItem() writes exactly that many.
+using ExportFormat = DataStructure::ExportFormat;
 
-// Attempts to parse an item identifier string into its bucket keys.
-// Returns true if parsing succeeded, false if the identifier is invalid.
-// Valid format: "FirstWord SecondWord" where both words start with A-Z.
-bool tryParseItemIdentifier(const char* itemIdentifier, ParsedItemIdentifier& parsedResult) {
-  if (!itemIdentifier || itemIdentifier[0] == '\0') {
-    return false;
+constexpr char CSV_HEADER[] = "ID,Code,Time\n";
+constexpr std::size_t CSV_HEADER_LENGTH = sizeof(CSV_HEADER) - 1;
+constexpr char HEX_DIGITS[] = "0123456789abcdef";
+
+// Largest number of characters of a formatted Code.
+constexpr std::size_t MAX_CODE_LENGTH = 20;
+
+bool csvNeedsQuoting(const char* text) {
+  return std::strpbrk(text, ",\"\r\n") != nullptr;
+}
+
+// Length of text as a CSV field (quoted with doubled quotes if necessary).
+std::size_t csvFieldLength(const char* text) {
+  if (!text) {
+    return 0;
+  }
+  std::size_t length = std::strlen(text);
+  if (csvNeedsQuoting(text)) {
+    length += 2;
+    for (const char* character = text; *character; ++character) {
+      length += *character == '"';
+    }
   }
+  return length;
+}
 
-  const char firstWordInitial = itemIdentifier[0];
-  if (firstWordInitial < FIRST_VALID_LETTER || firstWordInitial > LAST_VALID_LETTER) {
-    return false;
+char* writeCsvField(const char* text, char* output) {
+  if (!text) {
+    return output;
+  }
+  if (!csvNeedsQuoting(text)) {
+    const std::size_t length = std::strlen(text);
+    std::memcpy(output, text, length);
+    return output + length;
   }
+  *output++ = '"';
+  for (const char* character = text; *character; ++character) {
+    if (*character == '"') {
+      *output++ = '"';
+    }
+    *output++ = *character;
+  }
+  *output++ = '"';
+  return output;
+}
 
-  const char* spacePosition = std::strchr(itemIdentifier, WORD_SEPARATOR);
-  if (!spacePosition || !spacePosition[1]) {
-    return false;
+// Length of text as a JSON string including the quotes, or of null.
+// Quotes and backslashes take two characters, other control characters six.
+std::size_t jsonStringLength(const char* text) {
+  if (!text) {
+    return 4;
+  }
+  std::size_t length = 2;
+  for (const char* character = text; *character; ++character) {
+    const unsigned char code = static_cast<unsigned char>(*character);
+    length += code == '"' || code == '\\' ? 2 : code < 0x20 ? 6 : 1;
   }
+  return length;
+}
 
-  const char secondWordInitial = spacePosition[1];
-  if (secondWordInitial < FIRST_VALID_LETTER || secondWordInitial > LAST_VALID_LETTER) {
-    return false;
+char* writeJsonString(const char* text, char* output) {
+  if (!text) {
+    std::memcpy(output, "null", 4);
+    return output + 4;
+  }
+  *output++ = '"';
+  for (const char* character = text; *character; ++character) {
+    const unsigned char code = static_cast<unsigned char>(*character);
+    if (code == '"' || code == '\\') {
+      *output++ = '\\';
+      *output++ = static_cast<char>(code);
+    } else if (code < 0x20) {
+      std::memcpy(output, "\\u00", 4);
+      output[4] = HEX_DIGITS[code >> 4];
+      output[5] = HEX_DIGITS[code & 0xF];
+      output += 6;
+    } else {
+      *output++ = static_cast<char>(code);
+    }
   }
+  *output++ = '"';
+  return output;
+}
+
+std::size_t codeLength(unsigned long code) {
+  char digits[MAX_CODE_LENGTH];
+  return static_cast<std::size_t>(std::to_chars(digits, digits + MAX_CODE_LENGTH, code).ptr - digits);
+}
 
-  parsedResult.firstWordInitial = firstWordInitial;
-  parsedResult.secondWordIndex = static_cast<std::size_t>(secondWordInitial - FIRST_VALID_LETTER);
-  return true;
+char* writeCode(unsigned long code, char* output) {
+  return std::to_chars(output, output + MAX_CODE_LENGTH, code).ptr;
+}
+
+char* writeText(const char* text, std::size_t length, char* output) {
+  std::memcpy(output, text, length);
+  return output + length;
+}
+
+// Items without an ID are printed as "(null)", like operator<< of Item does.
+const char* printableId(const Item& item) {
+  return item.GetID() ? item.GetID() : "(null)";
+}
+
+constexpr char JSON_ID_KEY[] = "{\"id\":";
+constexpr char JSON_CODE_KEY[] = ",\"code\":";
+constexpr char JSON_TIME_KEY[] = ",\"time\":";
+constexpr std::size_t JSON_KEYS_LENGTH = sizeof(JSON_ID_KEY) + sizeof(JSON_CODE_KEY) + sizeof(JSON_TIME_KEY) - 3;
+
+// Typical length of an exported line, for the initial size of an export buffer.
+std::size_t estimatedLineLength(ExportFormat format) {
+  switch (format) {
+  case ExportFormat::Csv:
+    return 32;
+  case ExportFormat::Ndjson:
+    return 64;
+  default:
+    return 16;
+  }
+}
+
+// Number of characters formatItem writes for item, including the line break.
+std::size_t formattedLength(const Item& item, ExportFormat format) {
+  switch (format) {
+  case ExportFormat::Csv:
+    return csvFieldLength(item.GetID()) + 1 + codeLength(item.Code) + 1 + csvFieldLength(item.pTime) + 1;
+  case ExportFormat::Ndjson:
+    return JSON_KEYS_LENGTH + jsonStringLength(item.GetID()) + codeLength(item.Code) + jsonStringLength(item.pTime) +
+           2;
+  default:
+    return std::strlen(printableId(item)) + 1;
+  }
+}
+
+// Writes item as one line of the given format and returns the end of the output.
+char* formatItem(const Item& item, ExportFormat format, char* output) {
+  switch (format) {
+  case ExportFormat::Csv:
+    output = writeCsvField(item.GetID(), output);
+    *output++ = ',';
+    output = writeCode(item.Code, output);
+    *output++ = ',';
+    output = writeCsvField(item.pTime, output);
+    break;
+  case ExportFormat::Ndjson:
+    output = writeText(JSON_ID_KEY, sizeof(JSON_ID_KEY) - 1, output);
+    output = writeJsonString(item.GetID(), output);
+    output = writeText(JSON_CODE_KEY, sizeof(JSON_CODE_KEY) - 1, output);
+    output = writeCode(item.Code, output);
+    output = writeText(JSON_TIME_KEY, sizeof(JSON_TIME_KEY) - 1, output);
+    output = writeJsonString(item.pTime, output);
+    *output++ = '}';
+    break;
+  default:
+    output = writeText(printableId(item), std::strlen(printableId(item)), output);
+    break;
+  }
+  *output++ = '\n';
+  return output;
+}
+
+// Records the items offered to a bulk load, of which addedCount were added,
+// with the mean time per item since stopwatch was started.
+void recordBulkInsert(instrumentation::OperationRecorder& recorder, int offeredCount, int addedCount,
+                      const instrumentation::StatsStopwatch& stopwatch) {
+  if (offeredCount > 0) {
+    recorder.Record(static_cast<std::uint64_t>(addedCount), static_cast<std::uint64_t>(offeredCount - addedCount),
+                    stopwatch.ElapsedNanoseconds() / static_cast<std::uint64_t>(offeredCount));
+  }
+}
+
+// Number of lookups of a GetItems batch that are in flight at once: a
+// lookup's memory is prefetched this many steps before it is used.
+constexpr std::size_t BATCH_PIPELINE_DEPTH = 16;
+
+// Returns an array of lists that all allocate from nodeResource.
+template <typename List, std::size_t... ListIndexes>
+std::array<List, sizeof...(ListIndexes)> makeLists(std::pmr::memory_resource* nodeResource,
+                                                   std::index_sequence<ListIndexes...>) {
+  return {{((void)ListIndexes, List(nodeResource))...}};
 }
 
 } // namespace
 
+// The allocator of a std::pmr list is fixed at construction, so the lists are
+// built in place with the resource instead of being assigned afterwards.
+DataStructure::LinkedListBucket::LinkedListBucket(std::pmr::memory_resource* nodeResource)
+    : lists(makeLists<ItemList>(nodeResource, std::make_index_sequence<LETTER_COUNT>())) {}
+
+std::pmr::memory_resource* DataStructure::nodeResource() {
+  if (mOptions.nodeResource) {
+    return mOptions.nodeResource;
+  }
+  if (!mNodePool) {
+    mNodePool = std::make_unique<NodePool>();
+  }
+  return mNodePool.get();
+}
+
+// Hashed arrays allocate through their vectors, so they never create the node pool.
+std::unique_ptr<DataStructure::Bucket> DataStructure::makeBucket() {
+  if (usesHashedArrays()) {
+    return std::make_unique<HashedArrayBucket>();
+  }
+  return std::make_unique<LinkedListBucket>(nodeResource());
+}
+
+// Creates an empty data structure with the given settings.
+DataStructure::DataStructure(const Options& options) : mOptions(options) {}
+
+// Copy constructor: deep-copies every item of the original.
+// The indexes hold pointers into the original's lists, so they are rebuilt.
+DataStructure::DataStructure(const DataStructure& original) : mOptions(original.mOptions) {
+  copyItemsFrom(original);
+  if (mOptions.useIdIndex || usesSecondaryIndexes()) {
+    rebuildIndexes();
+  }
+}
+
+// Assignment operator: builds the copy first so that a failure leaves *this untouched.
+DataStructure& DataStructure::operator=(const DataStructure& right) {
+  if (this != &right) {
+    DataStructure copy(right);
+    *this = std::move(copy);
+  }
+  return *this;
+}
+
+// Move constructor: takes over the buckets and leaves the source empty.
+DataStructure::DataStructure(DataStructure&& source) noexcept
+    : mStringArena(std::move(source.mStringArena)), mNodePool(std::move(source.mNodePool)),
+      mBuckets(std::move(source.mBuckets)),
+      mItemCount(std::exchange(source.mItemCount, 0)), mOptions(source.mOptions),
+      mIdIndex(std::move(source.mIdIndex)), mCodeIndex(std::move(source.mCodeIndex)),
+      mTimeIndex(std::move(source.mTimeIndex)) {
+  source.mIdIndex.Clear();
+  source.mCodeIndex.Clear();
+  source.mTimeIndex.Clear();
+}
+
+// Move assignment: releases the current items and takes over those of the source.
+DataStructure& DataStructure::operator=(DataStructure&& source) noexcept {
+  if (this != &source) {
+    // The old items are destroyed before the arena their strings live in
+    // and the pool their nodes live in.
+    mBuckets = std::move(source.mBuckets);
+    mStringArena = std::move(source.mStringArena);
+    mNodePool = std::move(source.mNodePool);
+    mItemCount = std::exchange(source.mItemCount, 0);
+    mOptions = source.mOptions;
+    mIdIndex = std::move(source.mIdIndex);
+    mCodeIndex = std::move(source.mCodeIndex);
+    mTimeIndex = std::move(source.mTimeIndex);
+    source.mIdIndex.Clear();
+    source.mCodeIndex.Clear();
+    source.mTimeIndex.Clear();
+  }
+  return *this;
+}
+
+// Copies the lists of source one by one, appending at the tail of each
+// list so that the copy iterates in the same order as the original.
+void DataStructure::copyItemsFrom(const DataStructure& source) {
+  for (std::size_t bucketIndex = 0; bucketIndex < LETTER_COUNT; ++bucketIndex) {
+    const auto& sourceBucket = source.mBuckets[bucketIndex];
+    if (!sourceBucket) {
+      continue;
+    }
+
+    auto targetBucket = makeBucket();
+    for (std::size_t listIndex = 0; listIndex < LETTER_COUNT; ++listIndex) {
+      if (usesHashedArrays()) {
+        const HashedList& sourceList = hashedListOf(*sourceBucket, listIndex);
+        HashedList& targetList = hashedListOf(*targetBucket, listIndex);
+        targetList.fingerprints = sourceList.fingerprints;
+        targetList.idHashes = sourceList.idHashes;
+        targetList.items.reserve(sourceList.items.size());
+        for (const auto& sourceItem : sourceList.items) {
+          targetList.items.push_back(mOptions.useStringArena ? std::make_unique<Item>(*sourceItem, mStringArena)
+                                                             : std::make_unique<Item>(*sourceItem));
+        }
+        continue;
+      }
+
+      auto& targetList = linkedListOf(*targetBucket, listIndex);
+      auto tailIterator = targetList.before_begin();
+      for (const Item& sourceItem : linkedListOf(*sourceBucket, listIndex)) {
+        tailIterator = mOptions.useStringArena ? targetList.emplace_after(tailIterator, sourceItem, mStringArena)
+                                               : targetList.emplace_after(tailIterator, sourceItem);
+      }
+    }
+    targetBucket->listCounts = sourceBucket->listCounts;
+    targetBucket->itemCount = sourceBucket->itemCount;
+    mBuckets[bucketIndex] = std::move(targetBucket);
+  }
+  mItemCount = source.mItemCount;
+}
+
+// Clears the enabled indexes and adds every item currently held in the buckets.
+void DataStructure::rebuildIndexes() {
+  mIdIndex.Clear();
+  mCodeIndex.Clear();
+  mTimeIndex.Clear();
+  if (mOptions.useIdIndex) {
+    mIdIndex.Reserve(static_cast<std::size_t>(mItemCount));
+  }
+  if (mOptions.useCodeIndex) {
+    mCodeIndex.Reserve(static_cast<std::size_t>(mItemCount));
+  }
+  forEachItem([this](const Item& storedItem) {
+    Item* indexedItem = const_cast<Item*>(&storedItem);
+    if (mOptions.useIdIndex) {
+      mIdIndex.Insert(indexedItem, ItemIdIndex::Hash(storedItem.GetID()));
+    }
+    if (mOptions.useCodeIndex) {
+      mCodeIndex.Insert(indexedItem);
+    }
+    if (mOptions.useTimeIndex) {
+      mTimeIndex.Insert(indexedItem);
+    }
+  });
+}
+
+void DataStructure::addToSecondaryIndexes(Item* item) {
+  if (mOptions.useCodeIndex) {
+    mCodeIndex.Insert(item);
+  }
+  if (mOptions.useTimeIndex) {
+    try {
+      mTimeIndex.Insert(item);
+    } catch (...) {
+      removeFromSecondaryIndexes(item);
+      throw;
+    }
+  }
+}
+
+void DataStructure::removeFromSecondaryIndexes(const Item* item) {
+  if (mOptions.useCodeIndex) {
+    mCodeIndex.Erase(item);
+  }
+  if (mOptions.useTimeIndex) {
+    mTimeIndex.Erase(item);
+  }
+}
+
+DataStructure::ConstIterator::ConstIterator(const DataStructure& owner) : mOwner(&owner) {
+  enterNextList(0, 0);
+}
+
+// A hashed list is walked from its back, so that both layouts yield the
+// items of a list newest first.
+DataStructure::ConstIterator& DataStructure::ConstIterator::operator++() {
+  const Bucket& bucket = *mOwner->mBuckets[mBucketIndex];
+  if (mOwner->usesHashedArrays()) {
+    if (mHashedPosition > 0) {
+      mCurrent = hashedListOf(bucket, mListIndex).items[--mHashedPosition].get();
+      return *this;
+    }
+  } else if (++mListPosition != linkedListOf(bucket, mListIndex).end()) {
+    mCurrent = &*mListPosition;
+    return *this;
+  }
+
+  if (mListIndex + 1 < LETTER_COUNT) {
+    enterNextList(mBucketIndex, mListIndex + 1);
+  } else {
+    enterNextList(mBucketIndex + 1, 0);
+  }
+  return *this;
+}
+
+// The list counters tell which lists are empty without looking at them.
+void DataStructure::ConstIterator::enterNextList(std::size_t bucketIndex, std::size_t listIndex) {
+  for (; bucketIndex < LETTER_COUNT; ++bucketIndex, listIndex = 0) {
+    const auto& bucket = mOwner->mBuckets[bucketIndex];
+    if (!bucket) {
+      continue;
+    }
+    for (; listIndex < LETTER_COUNT; ++listIndex) {
+      if (bucket->listCounts[listIndex] == 0) {
+        continue;
+      }
+      mBucketIndex = bucketIndex;
+      mListIndex = listIndex;
+      if (mOwner->usesHashedArrays()) {
+        const auto& items = hashedListOf(*bucket, listIndex).items;
+        mHashedPosition = items.size() - 1;
+        mCurrent = items[mHashedPosition].get();
+      } else {
+        mListPosition = linkedListOf(*bucket, listIndex).begin();
+        mCurrent = &*mListPosition;
+      }
+      return;
+    }
+  }
+  mCurrent = nullptr;
+}
+
+template <typename Visitor>
+void DataStructure::forEachItem(Visitor&& visitor) const {
+  for (const auto& bucket : mBuckets) {
+    if (!bucket) {
+      continue;
+    }
+    for (std::size_t listIndex = 0; listIndex < LETTER_COUNT; ++listIndex) {
+      forEachListItem(*bucket, listIndex, visitor);
+    }
+  }
+}
+
+template <typename Predicate>
+void DataStructure::collectSorted(std::size_t firstBucket, std::size_t lastBucket, std::size_t firstList,
+                                  std::size_t lastList, Predicate&& isMatch,
+                                  std::vector<const Item*>& matches) const {
+  const std::size_t firstMatch = matches.size();
+  for (std::size_t bucketIndex = firstBucket; bucketIndex <= lastBucket; ++bucketIndex) {
+    const auto& bucket = mBuckets[bucketIndex];
+    if (!bucket) {
+      continue;
+    }
+    for (std::size_t listIndex = firstList; listIndex <= lastList; ++listIndex) {
+      forEachListItem(*bucket, listIndex, [&isMatch, &matches](const Item& storedItem) {
+        if (isMatch(storedItem.GetID())) {
+          matches.push_back(&storedItem);
+        }
+      });
+    }
+  }
+  std::sort(matches.begin() + static_cast<std::ptrdiff_t>(firstMatch), matches.end(),
+            [](const Item* left, const Item* right) { return std::strcmp(left->GetID(), right->GetID()) < 0; });
+}
+
+// IDs sharing a prefix share its first letter, and also their list if the
+// prefix extends past the word separator.
+void DataStructure::collectWithPrefix(const char* prefix, std::vector<const Item*>& matches) const {
+  const auto anyItem = [](const char*) { return true; };
+  if (!prefix || prefix[0] == '\0') {
+    collectSorted(0, LETTER_COUNT - 1, 0, LETTER_COUNT - 1, anyItem, matches);
+    return;
+  }
+
+  std::size_t bucketIndex;
+  if (!tryGetLetterIndex(prefix[0], bucketIndex)) {
+    return;
+  }
+  std::size_t firstList = 0;
+  std::size_t lastList = LETTER_COUNT - 1;
+  const char* spacePosition = std::strchr(prefix, item_identifier::WORD_SEPARATOR);
+  if (spacePosition && spacePosition[1]) {
+    if (!tryGetLetterIndex(spacePosition[1], firstList)) {
+      return;
+    }
+    lastList = firstList;
+  }
+
+  const std::size_t prefixLength = std::strlen(prefix);
+  collectSorted(
+      bucketIndex, bucketIndex, firstList, lastList,
+      [prefix, prefixLength](const char* itemIdentifier) { return std::strncmp(itemIdentifier, prefix, prefixLength) == 0; },
+      matches);
+}
+
+void DataStructure::collectInitialPair(char firstWordInitial, char secondWordInitial,
+                                       std::vector<const Item*>& matches) const {
+  std::size_t bucketIndex;
+  std::size_t listIndex;
+  if (!tryGetLetterIndex(firstWordInitial, bucketIndex) || !tryGetLetterIndex(secondWordInitial, listIndex)) {
+    return;
+  }
+  matches.reserve(matches.size() + static_cast<std::size_t>(GetListItemsNumber(firstWordInitial, secondWordInitial)));
+  collectSorted(bucketIndex, bucketIndex, listIndex, listIndex, [](const char*) { return true; }, matches);
+}
+
+// Every ID starts with A-Z, so the buckets outside the first letters of the
+// bounds cannot hold a match.
+void DataStructure::collectRange(const char* low, const char* high, std::vector<const Item*>& matches) const {
+  std::size_t firstBucket = 0;
+  std::size_t lastBucket = LETTER_COUNT - 1;
+  if (low && low[0] > item_identifier::FIRST_VALID_LETTER && !tryGetLetterIndex(low[0], firstBucket)) {
+    return;
+  }
+  if (high && high[0] < item_identifier::LAST_VALID_LETTER && !tryGetLetterIndex(high[0], lastBucket)) {
+    return;
+  }
+  if (firstBucket > lastBucket) {
+    return;
+  }
+  collectSorted(
+      firstBucket, lastBucket, 0, LETTER_COUNT - 1,
+      [low, high](const char* itemIdentifier) {
+        return (!low || std::strcmp(itemIdentifier, low) >= 0) && (!high || std::strcmp(itemIdentifier, high) < 0);
+      },
+      matches);
+}
+
+void DataStructure::collectWithCode(unsigned long code, std::vector<const Item*>& matches) const {
+  if (mOptions.useCodeIndex) {
+    mCodeIndex.FindAll(code, matches);
+    return;
+  }
+  forEachItem([code, &matches](const Item& storedItem) {
+    if (storedItem.Code == code) {
+      matches.push_back(&storedItem);
+    }
+  });
+}
+
+// The scan parses the time of every item and orders the matches by a
+// stable sort on their second of the day.
+void DataStructure::collectTimeRange(const char* firstTime, const char* lastTime,
+                                     std::vector<const Item*>& matches) const {
+  std::uint32_t firstSecond;
+  std::uint32_t lastSecond;
+  if (!item_time::tryPackTime(firstTime, firstSecond) || !item_time::tryPackTime(lastTime, lastSecond) ||
+      firstSecond > lastSecond) {
+    return;
+  }
+  if (mOptions.useTimeIndex) {
+    mTimeIndex.FindRange(firstSecond, lastSecond, matches);
+    return;
+  }
+
+  std::vector<std::pair<std::uint32_t, const Item*>> timedMatches;
+  forEachItem([firstSecond, lastSecond, &timedMatches](const Item& storedItem) {
+    std::uint32_t secondOfDay;
+    if (item_time::tryPackTime(storedItem.pTime, secondOfDay) && secondOfDay >= firstSecond &&
+        secondOfDay <= lastSecond) {
+      timedMatches.emplace_back(secondOfDay, &storedItem);
+    }
+  });
+  std::stable_sort(timedMatches.begin(), timedMatches.end(),
+                   [](const auto& left, const auto& right) { return left.first < right.first; });
+  matches.reserve(matches.size() + timedMatches.size());
+  for (const auto& timedMatch : timedMatches) {
+    matches.push_back(timedMatch.second);
+  }
+}
+
+// Linked lists are searched by string comparison; hashed lists scan the packed
+// fingerprints with SIMD and only check the hash and the ID string of candidates.
+Item* DataStructure::findInList(const Bucket& bucket, std::size_t listIndex, std::string_view itemIdentifier,
+                                std::uint64_t idHash) const {
+  if (usesHashedArrays()) {
+    const HashedList& hashedList = hashedListOf(bucket, listIndex);
+    const std::size_t itemCount = hashedList.fingerprints.size();
+    const std::size_t foundIndex = fingerprint_scan::findMatch(
+        hashedList.fingerprints.data(), itemCount, fingerprint_scan::fingerprintOf(idHash),
+        [&hashedList, itemIdentifier, idHash](std::size_t candidateIndex) {
+          return hashedList.idHashes[candidateIndex] == idHash &&
+                 identifierEquals(hashedList.items[candidateIndex]->GetID(), itemIdentifier);
+        });
+    return foundIndex == itemCount ? nullptr : hashedList.items[foundIndex].get();
+  }
+
+  const auto& itemList = linkedListOf(bucket, listIndex);
+  const auto foundItem =
+      std::find_if(itemList.begin(), itemList.end(), [itemIdentifier](const Item& candidateItem) {
+        return identifierEquals(candidateItem.GetID(), itemIdentifier);
+      });
+  return foundItem == itemList.end() ? nullptr : const_cast<Item*>(&(*foundItem));
+}
+
+// Removes all items. The items are destroyed before the string pool and the
+// node pool are freed.
+void DataStructure::Clear() {
+  for (auto& bucket : mBuckets) {
+    bucket.reset();
+  }
+  mItemCount = 0;
+  mIdIndex.Clear();
+  mCodeIndex.Clear();
+  mTimeIndex.Clear();
+  mStringArena.Release();
+  if (mNodePool) {
+    mNodePool->Release();
+  }
+}
+
 // Returns the total number of items stored in the data structure.
 int DataStructure::GetItemsNumber() const {
-  int totalCount = 0;
-  for (const auto& bucketEntry : mBuckets) {
-    for (const auto& itemList : bucketEntry.second) {
-      totalCount += static_cast<int>(std::distance(itemList.begin(), itemList.end()));
+  return mItemCount;
+}
+
+// The shape is read from the bucket and list counters only.
+DataStructure::Stats DataStructure::GetStats() const {
+  Stats stats;
+  stats.lookups = mLookupRecorder.Snapshot();
+  stats.inserts = mInsertRecorder.Snapshot();
+  stats.removes = mRemoveRecorder.Snapshot();
+  stats.providerCalls = Item::GetProviderCallStats();
+
+  stats.itemCount = static_cast<std::size_t>(mItemCount);
+  for (std::size_t bucketIndex = 0; bucketIndex < LETTER_COUNT; ++bucketIndex) {
+    const auto& bucket = mBuckets[bucketIndex];
+    if (!bucket) {
+      stats.listLengthCounts[0] += LETTER_COUNT;
+      continue;
     }
+    ++stats.allocatedBucketCount;
+    stats.bucketItemCounts[bucketIndex] = static_cast<std::size_t>(bucket->itemCount);
+    for (const int listCount : bucket->listCounts) {
+      std::size_t lengthClass = 0;
+      for (std::size_t remainingLength = static_cast<std::size_t>(listCount); remainingLength > 0;
+           remainingLength >>= 1) {
+        ++lengthClass;
+      }
+      ++stats.listLengthCounts[std::min(lengthClass, LIST_LENGTH_CLASS_COUNT - 1)];
+      stats.nonEmptyListCount += listCount > 0;
+      stats.longestListLength = std::max(stats.longestListLength, static_cast<std::size_t>(listCount));
+    }
+  }
+  return stats;
+}
+
+void DataStructure::ResetStats() {
+  mLookupRecorder.Reset();
+  mInsertRecorder.Reset();
+  mRemoveRecorder.Reset();
+}
+
+// Returns the number of items in the bucket for the given first-word initial.
+int DataStructure::GetBucketItemsNumber(char firstWordInitial) const {
+  std::size_t firstWordIndex;
+  if (!tryGetLetterIndex(firstWordInitial, firstWordIndex) || !mBuckets[firstWordIndex]) {
+    return 0;
+  }
+  return mBuckets[firstWordIndex]->itemCount;
+}
+
+// Returns the number of items in the list for the given pair of initials.
+int DataStructure::GetListItemsNumber(char firstWordInitial, char secondWordInitial) const {
+  std::size_t firstWordIndex;
+  std::size_t secondWordIndex;
+  if (!tryGetLetterIndex(firstWordInitial, firstWordIndex) ||
+      !tryGetLetterIndex(secondWordInitial, secondWordIndex) || !mBuckets[firstWordIndex]) {
+    return 0;
   }
-  return totalCount;
+  return mBuckets[firstWordIndex]->listCounts[secondWordIndex];
 }
 
 // Searches for an item by its identifier string.
 // Returns a pointer to the item if found, or nullptr if not found.
+// A null pID is treated like the empty ID, which is invalid.
 Item* DataStructure::GetItem(char* itemIdentifier) const {
+  return GetItem(itemIdentifier ? std::string_view(itemIdentifier) : std::string_view());
+}
+
+Item* DataStructure::GetItem(std::string_view itemIdentifier) const {
+  const instrumentation::StatsStopwatch stopwatch;
+  Item* foundItem = findItem(itemIdentifier);
+  mLookupRecorder.Record(foundItem != nullptr, stopwatch.ElapsedNanoseconds());
+  return foundItem;
+}
+
+bool DataStructure::Contains(std::string_view itemIdentifier) const {
+  return GetItem(itemIdentifier) != nullptr;
+}
+
+// The ID is parsed and compared in place: neither an index probe nor a list
+// search needs it NUL-terminated or computes its length again.
+Item* DataStructure::findItem(std::string_view itemIdentifier) const {
+  // Invalid identifiers are never indexed, so the index alone decides the result.
+  if (mOptions.useIdIndex) {
+    return mIdIndex.Find(itemIdentifier, ItemIdIndex::Hash(itemIdentifier));
+  }
+
   ParsedItemIdentifier parsedIdentifier;
   if (!tryParseItemIdentifier(itemIdentifier, parsedIdentifier)) {
     return nullptr;
   }
 
-  const auto bucketIterator = mBuckets.find(parsedIdentifier.firstWordInitial);
-  if (bucketIterator == mBuckets.end()) {
+  const auto& bucket = mBuckets[parsedIdentifier.firstWordIndex];
+  if (!bucket) {
     return nullptr;
   }
 
-  const auto& itemList = bucketIterator->second[parsedIdentifier.secondWordIndex];
-  const auto foundItem =
-      std::find_if(itemList.begin(), itemList.end(), [itemIdentifier](const Item& candidateItem) {
-        return std::strcmp(candidateItem.GetID(), itemIdentifier) == 0;
-      });
+  const std::uint64_t idHash = usesHashedArrays() ? ItemIdIndex::Hash(itemIdentifier) : 0;
+  return findInList(*bucket, parsedIdentifier.secondWordIndex, itemIdentifier, idHash);
+}
 
-  if (foundItem == itemList.end()) {
-    return nullptr;
+// The lookups of a batch overlap, so each is recorded with the mean time of the batch.
+int DataStructure::GetItems(char** itemIdentifiers, int identifierCount, Item** items) const {
+  if (identifierCount <= 0) {
+    return 0;
   }
+  const instrumentation::StatsStopwatch stopwatch;
+  const int foundCount = mOptions.useIdIndex ? getItemsFromIdIndex(itemIdentifiers, identifierCount, items)
+                                             : getItemsFromLists(itemIdentifiers, identifierCount, items);
+  mLookupRecorder.Record(static_cast<std::uint64_t>(foundCount),
+                         static_cast<std::uint64_t>(identifierCount - foundCount),
+                         stopwatch.ElapsedNanoseconds() / static_cast<std::uint64_t>(identifierCount));
+  return foundCount;
+}
 
-  return const_cast<Item*>(&(*foundItem));
+// Software pipeline: step i hashes ID i and prefetches its home slot, then
+// probes the slot of ID i - BATCH_PIPELINE_DEPTH, which has arrived by now.
+int DataStructure::getItemsFromIdIndex(char** itemIdentifiers, int identifierCount, Item** items) const {
+  const std::size_t queryCount = static_cast<std::size_t>(identifierCount);
+  std::uint64_t pendingHashes[BATCH_PIPELINE_DEPTH];
+  int foundCount = 0;
+  for (std::size_t step = 0; step < queryCount + BATCH_PIPELINE_DEPTH; ++step) {
+    if (step >= BATCH_PIPELINE_DEPTH) {
+      const std::size_t probedIndex = step - BATCH_PIPELINE_DEPTH;
+      if (itemIdentifiers[probedIndex]) {
+        items[probedIndex] =
+            mIdIndex.Find(itemIdentifiers[probedIndex], pendingHashes[probedIndex % BATCH_PIPELINE_DEPTH]);
+        foundCount += items[probedIndex] != nullptr;
+      }
+    }
+    if (step < queryCount) {
+      items[step] = nullptr;
+      if (itemIdentifiers[step]) {
+        const std::uint64_t idHash = ItemIdIndex::Hash(itemIdentifiers[step]);
+        pendingHashes[step % BATCH_PIPELINE_DEPTH] = idHash;
+        mIdIndex.Prefetch(idHash);
+      }
+    }
+  }
+  return foundCount;
 }
 
-// Adds an item to the data structure.
-// Throws an exception if the item's ID is invalid or if an item with the same ID already exists.
-void DataStructure::operator+=(Item& itemToAdd) {
+// The valid IDs are grouped by list first, so consecutive lookups mostly
+// scan the same list and find its memory cached.
+//
+// Hashed lists are scanned in the same pipeline as the ID index, with the
+// packed fingerprints of a list prefetched ahead of its scan.
+//
+// Linked lists are chased by up to BATCH_PIPELINE_DEPTH cursors in round
+// robin. Every cursor alternates between two steps, each issuing the
+// prefetch its next step depends on: from a node to the ID string it points
+// to, and from a compared ID string to the next node. While one cursor's
+// memory arrives, the others make progress.
+int DataStructure::getItemsFromLists(char** itemIdentifiers, int identifierCount, Item** items) const {
+  struct BatchQuery {
+    std::size_t listKey; // firstWordIndex * LETTER_COUNT + secondWordIndex
+    std::size_t queryIndex;
+  };
+
+  std::vector<BatchQuery> queries;
+  queries.reserve(static_cast<std::size_t>(identifierCount));
+  for (std::size_t queryIndex = 0; queryIndex < static_cast<std::size_t>(identifierCount); ++queryIndex) {
+    items[queryIndex] = nullptr;
+    ParsedItemIdentifier parsedIdentifier;
+    if (!tryParseItemIdentifier(itemIdentifiers[queryIndex], parsedIdentifier)) {
+      continue;
+    }
+    const auto& bucket = mBuckets[parsedIdentifier.firstWordIndex];
+    if (bucket && bucket->listCounts[parsedIdentifier.secondWordIndex] > 0) {
+      queries.push_back(
+          {parsedIdentifier.firstWordIndex * LETTER_COUNT + parsedIdentifier.secondWordIndex, queryIndex});
+    }
+  }
+  std::sort(queries.begin(), queries.end(),
+            [](const BatchQuery& left, const BatchQuery& right) { return left.listKey < right.listKey; });
+  auto bucketOf = [this](const BatchQuery& query) -> const Bucket& { return *mBuckets[query.listKey / LETTER_COUNT]; };
+
+  int foundCount = 0;
+  if (usesHashedArrays()) {
+    std::uint64_t pendingHashes[BATCH_PIPELINE_DEPTH];
+    for (std::size_t step = 0; step < queries.size() + BATCH_PIPELINE_DEPTH; ++step) {
+      if (step >= BATCH_PIPELINE_DEPTH) {
+        const BatchQuery& query = queries[step - BATCH_PIPELINE_DEPTH];
+        Item*& foundItem = items[query.queryIndex];
+        foundItem = findInList(bucketOf(query), query.listKey % LETTER_COUNT, itemIdentifiers[query.queryIndex],
+                               pendingHashes[(step - BATCH_PIPELINE_DEPTH) % BATCH_PIPELINE_DEPTH]);
+        foundCount += foundItem != nullptr;
+      }
+      if (step < queries.size()) {
+        const BatchQuery& query = queries[step];
+        pendingHashes[step % BATCH_PIPELINE_DEPTH] = ItemIdIndex::Hash(itemIdentifiers[query.queryIndex]);
+        memory_prefetch::prefetchForRead(
+            hashedListOf(bucketOf(query), query.listKey % LETTER_COUNT).fingerprints.data());
+      }
+    }
+    return foundCount;
+  }
+
+  struct ListCursor {
+    const BatchQuery* query = nullptr; // nullptr if the cursor is idle
+    ItemList::const_iterator position;
+    ItemList::const_iterator end;
+    bool isIdRequested = false; // The ID string of position is being prefetched
+  };
+
+  ListCursor cursors[BATCH_PIPELINE_DEPTH];
+  std::size_t nextQuery = 0;
+  std::size_t activeCursorCount = 0;
+  // Points an idle cursor at the head of the next query's list.
+  auto startQuery = [&](ListCursor& cursor) {
+    if (nextQuery == queries.size()) {
+      return;
+    }
+    const BatchQuery& query = queries[nextQuery++];
+    const auto& itemList = linkedListOf(bucketOf(query), query.listKey % LETTER_COUNT);
+    cursor.query = &query;
+    cursor.position = itemList.begin();
+    cursor.end = itemList.end();
+    cursor.isIdRequested = false;
+    memory_prefetch::prefetchForRead(&*cursor.position);
+    ++activeCursorCount;
+  };
+  auto finishQuery = [&](ListCursor& cursor) {
+    cursor.query = nullptr;
+    --activeCursorCount;
+    startQuery(cursor);
+  };
+
+  for (ListCursor& cursor : cursors) {
+    startQuery(cursor);
+  }
+  while (activeCursorCount > 0) {
+    for (ListCursor& cursor : cursors) {
+      if (!cursor.query) {
+        continue;
+      }
+      if (!cursor.isIdRequested) {
+        memory_prefetch::prefetchForRead(cursor.position->GetID());
+        cursor.isIdRequested = true;
+        continue;
+      }
+      if (std::strcmp(cursor.position->GetID(), itemIdentifiers[cursor.query->queryIndex]) == 0) {
+        items[cursor.query->queryIndex] = const_cast<Item*>(&*cursor.position);
+        ++foundCount;
+        finishQuery(cursor);
+        continue;
+      }
+      if (++cursor.position == cursor.end) {
+        finishQuery(cursor);
+        continue;
+      }
+      memory_prefetch::prefetchForRead(&*cursor.position);
+      cursor.isIdRequested = false;
+    }
+  }
+  return foundCount;
+}
+
+// Validates the ID of an item about to be added and locates its list.
+// Reports an invalid ID or an existing item with the same ID instead of adding.
+DataStructure::InsertCheck DataStructure::checkInsert(const char* itemIdentifier, InsertPosition& position) {
   ParsedItemIdentifier parsedIdentifier;
-  if (!tryParseItemIdentifier(itemToAdd.GetID(), parsedIdentifier)) {
-    throw std::runtime_error("Invalid ID");
+  if (!tryParseItemIdentifier(itemIdentifier, parsedIdentifier)) {
+    return InsertCheck::InvalidId;
   }
 
-  auto& itemList = mBuckets[parsedIdentifier.firstWordInitial][parsedIdentifier.secondWordIndex];
-  const auto duplicateItem =
-      std::find_if(itemList.begin(), itemList.end(), [&itemToAdd](const Item& existingItem) {
-        return std::strcmp(existingItem.GetID(), itemToAdd.GetID()) == 0;
-      });
+  auto& bucket = mBuckets[parsedIdentifier.firstWordIndex];
+  if (!bucket) {
+    bucket = makeBucket();
+  }
+
+  position = InsertPosition{bucket.get(), parsedIdentifier.secondWordIndex, 0};
+  if (mOptions.useIdIndex || usesHashedArrays()) {
+    position.idHash = ItemIdIndex::Hash(itemIdentifier);
+  }
+  const bool isDuplicate = mOptions.useIdIndex
+                               ? mIdIndex.Find(itemIdentifier, position.idHash) != nullptr
+                               : findInList(*bucket, position.listIndex, itemIdentifier, position.idHash) != nullptr;
+  return isDuplicate ? InsertCheck::AlreadyExists : InsertCheck::Ready;
+}
 
-  if (duplicateItem != itemList.end()) {
+// Validates the ID of an item about to be added and locates its list.
+// Throws an exception if the ID is invalid or if an item with the same ID already exists.
+DataStructure::InsertPosition DataStructure::prepareInsert(const char* itemIdentifier) {
+  InsertPosition position{};
+  switch (checkInsert(itemIdentifier, position)) {
+  case InsertCheck::InvalidId:
+    throw std::runtime_error("Invalid ID");
+  case InsertCheck::AlreadyExists:
     throw std::runtime_error("Item already exists");
+  case InsertCheck::Ready:
+    break;
+  }
+  return position;
+}
+
+// Constructs the item in place: from an lvalue copy into the arena, otherwise
+// from source as given, so an Item&& is moved and a char* ID is fetched.
+// checkInsert allocated the bucket already; if the item cannot be built
+// (e.g. the provider throws), a bucket left empty is released again.
+template <typename Source>
+Item* DataStructure::insertItem(const InsertPosition& position, Source&& source) {
+  try {
+    return commitInsert(position, constructItem(position, mStringArena, std::forward<Source>(source)));
+  } catch (...) {
+    releaseEmptyBuckets();
+    throw;
+  }
+}
+
+void DataStructure::releaseEmptyBuckets() {
+  for (auto& bucket : mBuckets) {
+    if (bucket && bucket->itemCount == 0) {
+      bucket.reset();
+    }
+  }
+}
+
+template <typename Source>
+Item* DataStructure::constructItem(const InsertPosition& position, StringArena& arena, Source&& source) {
+  if (usesHashedArrays()) {
+    HashedList& hashedList = hashedListOf(*position.bucket, position.listIndex);
+    reserveForOneMore(hashedList.fingerprints);
+    reserveForOneMore(hashedList.idHashes);
+    hashedList.items.push_back(mOptions.useStringArena ? std::make_unique<Item>(source, arena)
+                                                       : std::make_unique<Item>(std::forward<Source>(source)));
+    hashedList.fingerprints.push_back(fingerprint_scan::fingerprintOf(position.idHash));
+    hashedList.idHashes.push_back(position.idHash);
+    return hashedList.items.back().get();
+  }
+
+  auto& itemList = linkedListOf(*position.bucket, position.listIndex);
+  if (mOptions.useStringArena) {
+    itemList.emplace_front(source, arena);
+  } else {
+    itemList.emplace_front(std::forward<Source>(source));
+  }
+  return &itemList.front();
+}
+
+// Removes the item added last to the list at position.
+void DataStructure::discardNewestItem(const InsertPosition& position) {
+  if (usesHashedArrays()) {
+    HashedList& hashedList = hashedListOf(*position.bucket, position.listIndex);
+    hashedList.items.pop_back();
+    hashedList.fingerprints.pop_back();
+    hashedList.idHashes.pop_back();
+  } else {
+    linkedListOf(*position.bucket, position.listIndex).pop_front();
+  }
+}
+
+// Registers the item just added to the list at position with the indexes
+// and the counters, and returns it. If an index throws, the item is
+// unlinked from all of them and destroyed again.
+Item* DataStructure::commitInsert(const InsertPosition& position, Item* addedItem) {
+  if (mOptions.useIdIndex) {
+    try {
+      mIdIndex.Insert(addedItem, position.idHash);
+    } catch (...) {
+      discardNewestItem(position);
+      throw;
+    }
+  }
+  if (usesSecondaryIndexes()) {
+    try {
+      addToSecondaryIndexes(addedItem);
+    } catch (...) {
+      if (mOptions.useIdIndex) {
+        mIdIndex.Erase(addedItem->GetID(), position.idHash);
+      }
+      discardNewestItem(position);
+      throw;
+    }
+  }
+  ++position.bucket->listCounts[position.listIndex];
+  ++position.bucket->itemCount;
+  ++mItemCount;
+  return addedItem;
+}
+
+// Adds a copy of an item to the data structure.
+// Throws an exception if the item's ID is invalid or if an item with the same ID already exists.
+void DataStructure::operator+=(Item& itemToAdd) {
+  instrumentation::OperationScope insertScope(mInsertRecorder);
+  const InsertPosition position = prepareInsert(itemToAdd.GetID());
+  insertItem(position, static_cast<const Item&>(itemToAdd));
+  insertScope.Succeed();
+}
+
+// Adds an item to the data structure, moving its strings into the list node.
+// Throws an exception if the item's ID is invalid or if an item with the same ID already exists;
+// the item is left untouched in that case.
+void DataStructure::operator+=(Item&& itemToAdd) {
+  instrumentation::OperationScope insertScope(mInsertRecorder);
+  const InsertPosition position = prepareInsert(itemToAdd.GetID());
+  insertItem(position, std::move(itemToAdd));
+  insertScope.Succeed();
+}
+
+// Fetches the item with the given identifier from the provider directly into a new list node.
+// The ID is validated and checked for duplicates before the provider is called.
+Item* DataStructure::Emplace(char* itemIdentifier) {
+  instrumentation::OperationScope insertScope(mInsertRecorder);
+  const InsertPosition position = prepareInsert(itemIdentifier);
+  Item* addedItem = insertItem(position, itemIdentifier);
+  insertScope.Succeed();
+  return addedItem;
+}
+
+// Builds a GetStruct1 structure of itemCount items in one call into the data source.
+// Its headers are already grouped by first and second initial, so walking them
+// visits every bucket and list once. Each item is copied in; the source
+// structure itself is left alone, since DataSource.dll allocates it on the
+// heap of another C runtime and exports no function to free it.
+int DataStructure::LoadBulk(int itemCount) {
+  if (itemCount <= 0) {
+    return 0;
+  }
+
+  const instrumentation::StatsStopwatch stopwatch;
+  HEADER_B* sourceStructure = GetStruct1(1, itemCount);
+  if (!sourceStructure) {
+    throw std::runtime_error("Failed to retrieve items from provider");
   }
 
-  itemList.push_front(itemToAdd);
+  int offeredCount = 0;
+  int addedCount = 0;
+  for (const HEADER_B* firstLevelHeader = sourceStructure; firstLevelHeader;
+       firstLevelHeader = firstLevelHeader->pNext) {
+    for (const HEADER_A* secondLevelHeader = firstLevelHeader->pHeaderA; secondLevelHeader;
+         secondLevelHeader = secondLevelHeader->pNext) {
+      for (const ITEM1* sourceItem = static_cast<const ITEM1*>(secondLevelHeader->pItems); sourceItem;
+           sourceItem = sourceItem->pNext) {
+        ++offeredCount;
+        InsertPosition position{};
+        if (checkInsert(sourceItem->pID, position) != InsertCheck::Ready) {
+          continue;
+        }
+        insertItem(position, *sourceItem);
+        ++addedCount;
+      }
+    }
+  }
+
+  recordBulkInsert(mInsertRecorder, offeredCount, addedCount, stopwatch);
+  return addedCount;
+}
+
+// Adds the items with the given identifiers. The valid identifiers are first ordered
+// by (first initial, second initial), so the inserts walk the buckets in table order.
+int DataStructure::LoadBulk(char** itemIdentifiers, int identifierCount) {
+  struct PendingIdentifier {
+    std::size_t listKey; // firstWordIndex * LETTER_COUNT + secondWordIndex
+    char* itemIdentifier;
+  };
+
+  const instrumentation::StatsStopwatch stopwatch;
+  std::vector<PendingIdentifier> pendingIdentifiers;
+  pendingIdentifiers.reserve(identifierCount > 0 ? static_cast<std::size_t>(identifierCount) : 0);
+  for (int identifierIndex = 0; identifierIndex < identifierCount; ++identifierIndex) {
+    ParsedItemIdentifier parsedIdentifier;
+    if (tryParseItemIdentifier(itemIdentifiers[identifierIndex], parsedIdentifier)) {
+      pendingIdentifiers.push_back(
+          {parsedIdentifier.firstWordIndex * LETTER_COUNT + parsedIdentifier.secondWordIndex,
+           itemIdentifiers[identifierIndex]});
+    }
+  }
+  std::stable_sort(pendingIdentifiers.begin(), pendingIdentifiers.end(),
+                   [](const PendingIdentifier& left, const PendingIdentifier& right) {
+                     return left.listKey < right.listKey;
+                   });
+
+  int addedCount = 0;
+  for (const PendingIdentifier& pendingIdentifier : pendingIdentifiers) {
+    // Repeated IDs are caught here, since the earlier copy is already stored.
+    InsertPosition position{};
+    if (checkInsert(pendingIdentifier.itemIdentifier, position) != InsertCheck::Ready) {
+      continue;
+    }
+    insertItem(position, pendingIdentifier.itemIdentifier);
+    ++addedCount;
+  }
+  recordBulkInsert(mInsertRecorder, std::max(identifierCount, 0), addedCount, stopwatch);
+  return addedCount;
+}
+
+// Finished fetches are handed from the workers to this thread through a
+// queue. IDs that cannot be added are filtered out before their fetch; the
+// check is repeated on arrival, since a repeated ID may have been fetched
+// twice while neither copy was stored yet.
+int DataStructure::LoadAsync(char** itemIdentifiers, int identifierCount, AsyncItemFetcher& fetcher,
+                             std::size_t maxInFlight) {
+  struct CompletedFetches {
+    std::mutex mutex;
+    std::condition_variable available;
+    std::deque<AsyncItemFetcher::FetchResult> results;
+  };
+
+  const instrumentation::StatsStopwatch stopwatch;
+  if (maxInFlight == 0) {
+    maxInFlight = 2 * fetcher.GetThreadCount();
+  }
+  CompletedFetches completed;
+  std::size_t inFlightCount = 0;
+  std::exception_ptr firstFailure;
+  int addedCount = 0;
+  int nextIdentifier = 0;
+  const int offeredCount = std::max(identifierCount, 0);
+
+  while (true) {
+    while (!firstFailure && inFlightCount < maxInFlight && nextIdentifier < identifierCount) {
+      char* itemIdentifier = itemIdentifiers[nextIdentifier++];
+      InsertPosition position{};
+      if (checkInsert(itemIdentifier, position) != InsertCheck::Ready) {
+        continue;
+      }
+      ++inFlightCount;
+      try {
+        // Notifying under the lock keeps completed alive until the worker
+        // is done with it: this thread cannot return before taking the lock.
+        fetcher.FetchAsync(itemIdentifier, [&completed](AsyncItemFetcher::FetchResult&& result) {
+          std::lock_guard<std::mutex> lock(completed.mutex);
+          completed.results.push_back(std::move(result));
+          completed.available.notify_one();
+        });
+      } catch (...) {
+        --inFlightCount;
+        firstFailure = std::current_exception();
+      }
+    }
+    if (inFlightCount == 0) {
+      break;
+    }
+
+    AsyncItemFetcher::FetchResult result;
+    {
+      std::unique_lock<std::mutex> lock(completed.mutex);
+      completed.available.wait(lock, [&completed]() { return !completed.results.empty(); });
+      result = std::move(completed.results.front());
+      completed.results.pop_front();
+    }
+    --inFlightCount;
+    if (firstFailure) {
+      continue;
+    }
+    if (!result.item) {
+      firstFailure = result.failure;
+      continue;
+    }
+
+    InsertPosition position{};
+    if (checkInsert(result.item->GetID(), position) != InsertCheck::Ready) {
+      continue;
+    }
+    try {
+      insertItem(position, std::move(*result.item));
+      ++addedCount;
+    } catch (...) {
+      firstFailure = std::current_exception();
+    }
+  }
+
+  recordBulkInsert(mInsertRecorder, offeredCount, addedCount, stopwatch);
+  if (firstFailure) {
+    // The check before each fetch allocated the buckets of the fetched IDs.
+    releaseEmptyBuckets();
+    std::rethrow_exception(firstFailure);
+  }
+  return addedCount;
+}
+
+std::size_t DataStructure::parallelWorkerCount(unsigned threadCount, std::size_t taskCount) {
+  if (threadCount == 0) {
+    threadCount = std::max(1u, std::thread::hardware_concurrency());
+  }
+  return std::max<std::size_t>(1, std::min<std::size_t>(threadCount, taskCount));
+}
+
+// The calling thread is worker 0. Tasks are taken from a shared counter, so
+// a worker that finishes early keeps taking tasks instead of idling. If a
+// thread cannot be started (std::system_error, or std::bad_alloc for its
+// state), the tasks are shared among those that could.
+void DataStructure::runInParallel(std::size_t taskCount, std::size_t workerCount,
+                                  const std::function<void(std::size_t, std::size_t)>& runTask) {
+  std::atomic<std::size_t> nextTask{0};
+  std::atomic<bool> hasFailed{false};
+  std::exception_ptr firstFailure;
+  std::mutex failureMutex;
+  auto runWorker = [&](std::size_t workerIndex) {
+    for (std::size_t taskIndex = nextTask++; taskIndex < taskCount && !hasFailed; taskIndex = nextTask++) {
+      try {
+        runTask(workerIndex, taskIndex);
+      } catch (...) {
+        const std::lock_guard<std::mutex> failureLock(failureMutex);
+        if (!firstFailure) {
+          firstFailure = std::current_exception();
+        }
+        hasFailed = true;
+      }
+    }
+  };
+
+  std::vector<std::thread> workerThreads;
+  workerThreads.reserve(workerCount > 0 ? workerCount - 1 : 0);
+  for (std::size_t workerIndex = 1; workerIndex < workerCount; ++workerIndex) {
+    try {
+      workerThreads.emplace_back(runWorker, workerIndex);
+    } catch (const std::system_error&) {
+      break;
+    } catch (const std::bad_alloc&) {
+      break;
+    }
+  }
+  runWorker(0);
+  for (std::thread& workerThread : workerThreads) {
+    workerThread.join();
+  }
+  if (firstFailure) {
+    std::rethrow_exception(firstFailure);
+  }
+}
+
+// Largest first, like the lists of BuildParallel.
+std::vector<DataStructure::ListReference> DataStructure::collectNonEmptyLists() const {
+  std::vector<ListReference> nonEmptyLists;
+  for (const auto& bucket : mBuckets) {
+    if (!bucket) {
+      continue;
+    }
+    for (std::size_t listIndex = 0; listIndex < LETTER_COUNT; ++listIndex) {
+      if (bucket->listCounts[listIndex] > 0) {
+        nonEmptyLists.push_back({bucket.get(), listIndex});
+      }
+    }
+  }
+  std::sort(nonEmptyLists.begin(), nonEmptyLists.end(), [](const ListReference& left, const ListReference& right) {
+    return left.bucket->listCounts[left.listIndex] > right.bucket->listCounts[right.listIndex];
+  });
+  return nonEmptyLists;
+}
+
+// The (sum, minimum, maximum) of every list is folded into the result of one worker.
+DataStructure::CodeStatistics DataStructure::GetCodeStatistics(unsigned threadCount) const {
+  CodeStatistics identity;
+  identity.minimum = std::numeric_limits<unsigned long>::max();
+  return ParallelReduce(
+      identity,
+      [](const Item& storedItem) {
+        CodeStatistics itemStatistics;
+        itemStatistics.count = 1;
+        itemStatistics.sum = storedItem.Code;
+        itemStatistics.minimum = storedItem.Code;
+        itemStatistics.maximum = storedItem.Code;
+        return itemStatistics;
+      },
+      [](const CodeStatistics& left, const CodeStatistics& right) {
+        CodeStatistics combined;
+        combined.count = left.count + right.count;
+        combined.sum = left.sum + right.sum;
+        combined.minimum = std::min(left.minimum, right.minimum);
+        combined.maximum = std::max(left.maximum, right.maximum);
+        return combined;
+      },
+      threadCount);
+}
+
+// A list filled by BuildParallel: its position, its slice of the partitioned
+// input, and the items added to it so far.
+struct DataStructure::ParallelListBuild {
+  InsertPosition position;
+  const std::size_t* firstItemIndex;
+  const std::size_t* lastItemIndex;
+  ItemIdIndex addedIds; // Only used with mOptions.useIdIndex
+  int addedCount = 0;
+};
+
+// Duplicates are checked against the ID index, which no worker writes to, or
+// against the list itself, which no other worker touches.
+void DataStructure::fillParallelList(ParallelListBuild& build, const std::vector<Item>& items, StringArena& arena) {
+  const bool needsIdHash = mOptions.useIdIndex || usesHashedArrays();
+  if (mOptions.useIdIndex) {
+    build.addedIds.Reserve(static_cast<std::size_t>(build.lastItemIndex - build.firstItemIndex));
+  }
+  for (const std::size_t* itemIndex = build.firstItemIndex; itemIndex != build.lastItemIndex; ++itemIndex) {
+    const Item& sourceItem = items[*itemIndex];
+    const char* itemIdentifier = sourceItem.GetID();
+    InsertPosition position = build.position;
+    position.idHash = needsIdHash ? ItemIdIndex::Hash(itemIdentifier) : 0;
+    const bool isDuplicate =
+        mOptions.useIdIndex
+            ? mIdIndex.Find(itemIdentifier, position.idHash) || build.addedIds.Find(itemIdentifier, position.idHash)
+            : findInList(*position.bucket, position.listIndex, itemIdentifier, position.idHash) != nullptr;
+    if (isDuplicate) {
+      continue;
+    }
+
+    Item* addedItem = constructItem(position, arena, sourceItem);
+    if (mOptions.useIdIndex) {
+      try {
+        build.addedIds.Insert(addedItem, position.idHash);
+      } catch (...) {
+        discardNewestItem(position);
+        throw;
+      }
+    }
+    ++build.addedCount;
+  }
+}
+
+// The newest items of a list are at the front of a linked list and at the
+// back of a hashed one.
+template <typename Visitor>
+void DataStructure::forEachNewestItem(const ParallelListBuild& build, Visitor&& visitor) {
+  const std::size_t addedCount = static_cast<std::size_t>(build.addedCount);
+  if (usesHashedArrays()) {
+    auto& items = hashedListOf(*build.position.bucket, build.position.listIndex).items;
+    for (std::size_t itemIndex = items.size() - addedCount; itemIndex < items.size(); ++itemIndex) {
+      visitor(*items[itemIndex]);
+    }
+    return;
+  }
+  auto addedItem = linkedListOf(*build.position.bucket, build.position.listIndex).begin();
+  for (std::size_t itemNumber = 0; itemNumber < addedCount; ++itemNumber, ++addedItem) {
+    visitor(*addedItem);
+  }
+}
+
+// The input is partitioned with a counting sort on the list key, which keeps
+// the input order within each list. The lists are handed to the workers
+// largest first, so that a worker that finishes early keeps taking lists
+// from the others instead of idling. The shared state - the
+// counters, the indexes and the string pool - is updated only after all
+// workers have stopped; the ID index is reserved beforehand so that merging
+// into it cannot fail, and the secondary indexes are filled while a failure
+// can still be rolled back.
+int DataStructure::BuildParallel(const std::vector<Item>& items, unsigned threadCount) {
+  constexpr std::size_t LIST_COUNT = LETTER_COUNT * LETTER_COUNT;
+  constexpr std::size_t INVALID_LIST_KEY = LIST_COUNT;
+  const instrumentation::StatsStopwatch stopwatch;
+
+  std::vector<std::size_t> listKeys(items.size());
+  std::vector<std::size_t> listStarts(LIST_COUNT + 2, 0);
+  for (std::size_t itemIndex = 0; itemIndex < items.size(); ++itemIndex) {
+    ParsedItemIdentifier parsedIdentifier;
+    listKeys[itemIndex] = tryParseItemIdentifier(items[itemIndex].GetID(), parsedIdentifier)
+                              ? parsedIdentifier.firstWordIndex * LETTER_COUNT + parsedIdentifier.secondWordIndex
+                              : INVALID_LIST_KEY;
+    ++listStarts[listKeys[itemIndex] + 1];
+  }
+  for (std::size_t listKey = 0; listKey <= LIST_COUNT; ++listKey) {
+    listStarts[listKey + 1] += listStarts[listKey];
+  }
+  const std::size_t validItemCount = listStarts[LIST_COUNT];
+  std::vector<std::size_t> orderedItemIndices(items.size());
+  {
+    std::vector<std::size_t> nextSlots(listStarts.begin(), listStarts.end() - 1);
+    for (std::size_t itemIndex = 0; itemIndex < items.size(); ++itemIndex) {
+      orderedItemIndices[nextSlots[listKeys[itemIndex]]++] = itemIndex;
+    }
+  }
+
+  if (mOptions.useIdIndex) {
+    mIdIndex.Reserve(mIdIndex.Size() + validItemCount);
+  }
+  if (mOptions.useCodeIndex) {
+    mCodeIndex.Reserve(mCodeIndex.Size() + validItemCount);
+  }
+  std::vector<ParallelListBuild> builds;
+  try {
+    for (std::size_t listKey = 0; listKey < LIST_COUNT; ++listKey) {
+      if (listStarts[listKey] == listStarts[listKey + 1]) {
+        continue;
+      }
+      auto& bucket = mBuckets[listKey / LETTER_COUNT];
+      if (!bucket) {
+        bucket = makeBucket();
+      }
+      builds.push_back({InsertPosition{bucket.get(), listKey % LETTER_COUNT, 0},
+                        orderedItemIndices.data() + listStarts[listKey],
+                        orderedItemIndices.data() + listStarts[listKey + 1], ItemIdIndex(), 0});
+    }
+    std::sort(builds.begin(), builds.end(), [](const ParallelListBuild& left, const ParallelListBuild& right) {
+      return left.lastItemIndex - left.firstItemIndex > right.lastItemIndex - right.firstItemIndex;
+    });
+
+    const std::size_t workerCount = parallelWorkerCount(threadCount, builds.size());
+    std::vector<StringArena> workerArenas(workerCount);
+    {
+      // The workers fill different lists, but those share the node pool.
+      const NodePool::SharedScope sharedNodes(workerCount > 1 ? mNodePool.get() : nullptr);
+      runInParallel(builds.size(), workerCount, [&](std::size_t workerIndex, std::size_t buildIndex) {
+        fillParallelList(builds[buildIndex], items, workerArenas[workerIndex]);
+      });
+    }
+    for (StringArena& workerArena : workerArenas) {
+      mStringArena.Absorb(std::move(workerArena));
+    }
+    if (usesSecondaryIndexes()) {
+      for (const ParallelListBuild& build : builds) {
+        forEachNewestItem(build, [this](Item& addedItem) { addToSecondaryIndexes(&addedItem); });
+      }
+    }
+  } catch (...) {
+    // Unlink the items of this call again; the lists hold them newest first.
+    // A bucket allocated above for a list that got no item is released too.
+    for (ParallelListBuild& build : builds) {
+      if (usesSecondaryIndexes()) {
+        forEachNewestItem(build, [this](Item& addedItem) { removeFromSecondaryIndexes(&addedItem); });
+      }
+      for (; build.addedCount > 0; --build.addedCount) {
+        discardNewestItem(build.position);
+      }
+    }
+    releaseEmptyBuckets();
+    throw;
+  }
+
+  int addedCount = 0;
+  for (ParallelListBuild& build : builds) {
+    build.position.bucket->listCounts[build.position.listIndex] += build.addedCount;
+    build.position.bucket->itemCount += build.addedCount;
+    addedCount += build.addedCount;
+    if (mOptions.useIdIndex) {
+      mIdIndex.InsertAll(build.addedIds);
+    }
+  }
+  mItemCount += addedCount;
+  recordBulkInsert(mInsertRecorder, static_cast<int>(items.size()), addedCount, stopwatch);
+  return addedCount;
 }
 
 // Removes an item from the data structure by its identifier.
 // Throws an exception if the item is not found or the ID is invalid.
 void DataStructure::operator-=(char* itemIdentifier) {
+  Remove(itemIdentifier ? std::string_view(itemIdentifier) : std::string_view());
+}
+
+void DataStructure::Remove(std::string_view itemIdentifier) {
+  instrumentation::OperationScope removeScope(mRemoveRecorder);
+
   // Parse the identifier to extract the bucket keys
   ParsedItemIdentifier parsedIdentifier;
   if (!tryParseItemIdentifier(itemIdentifier, parsedIdentifier)) {
@@ -130,29 +1488,70 @@ void DataStructure::operator-=(char* itemIdentifier) {
   }
 
   // Find the bucket corresponding to the first word's initial letter
-  auto bucketIterator = mBuckets.find(parsedIdentifier.firstWordInitial);
-  if (bucketIterator == mBuckets.end()) {
+  auto& bucket = mBuckets[parsedIdentifier.firstWordIndex];
+  if (!bucket) {
     throw std::runtime_error("Item not found");
   }
 
+  // With the ID index, the item is located by hash; the list below then
+  // only has to be searched for its node address, without string compares.
+  const Item* indexedItem = nullptr;
+  if (mOptions.useIdIndex) {
+    indexedItem = mIdIndex.Erase(itemIdentifier, ItemIdIndex::Hash(itemIdentifier));
+    if (!indexedItem) {
+      throw std::runtime_error("Item not found");
+    }
+  }
+
+  // A hashed list is searched by hash unless the index already found the item;
+  // the item is then located among the packed pointers and erased from all arrays.
+  if (usesHashedArrays()) {
+    HashedList& hashedList = hashedListOf(*bucket, parsedIdentifier.secondWordIndex);
+    if (!indexedItem) {
+      indexedItem = findInList(*bucket, parsedIdentifier.secondWordIndex, itemIdentifier,
+                               ItemIdIndex::Hash(itemIdentifier));
+      if (!indexedItem) {
+        throw std::runtime_error("Item not found");
+      }
+    }
+    const auto removedItem = std::find_if(hashedList.items.begin(), hashedList.items.end(),
+                                          [indexedItem](const auto& storedItem) { return storedItem.get() == indexedItem; });
+    removeFromSecondaryIndexes(indexedItem);
+    const auto removedIndex = removedItem - hashedList.items.begin();
+    hashedList.fingerprints.erase(hashedList.fingerprints.begin() + removedIndex);
+    hashedList.idHashes.erase(hashedList.idHashes.begin() + removedIndex);
+    hashedList.items.erase(removedItem);
+    --bucket->listCounts[parsedIdentifier.secondWordIndex];
+    --bucket->itemCount;
+    --mItemCount;
+    if (bucket->itemCount == 0) {
+      bucket.reset();
+    }
+    removeScope.Succeed();
+    return;
+  }
+
   // Access the linked list for the second word's initial letter
-  auto& itemList = bucketIterator->second[parsedIdentifier.secondWordIndex];
+  auto& itemList = linkedListOf(*bucket, parsedIdentifier.secondWordIndex);
   auto previousIterator = itemList.before_begin();
   for (auto currentIterator = itemList.begin(); currentIterator != itemList.end(); ++currentIterator) {
     // Check if the current item matches the identifier we're looking for
-    if (std::strcmp(currentIterator->GetID(), itemIdentifier) == 0) {
-      // Remove the item from the linked list
+    const bool isMatch = indexedItem ? &(*currentIterator) == indexedItem
+                                     : identifierEquals(currentIterator->GetID(), itemIdentifier);
+    if (isMatch) {
+      // Remove the item from the secondary indexes and the linked list
+      removeFromSecondaryIndexes(&(*currentIterator));
       itemList.erase_after(previousIterator);
+      --bucket->listCounts[parsedIdentifier.secondWordIndex];
+      --bucket->itemCount;
+      --mItemCount;
 
-      // Check if the entire bucket (all 26 lists) is now empty
-      if (itemList.empty()) {
-        const bool isBucketCompletelyEmpty = std::all_of(
-            bucketIterator->second.begin(), bucketIterator->second.end(),
-            [](const auto& candidateList) { return candidateList.empty(); });
-        // Note: The bucket could be removed from the map here if empty,
-        // but this optimization is not implemented.
-        (void)isBucketCompletelyEmpty; // Suppress unused variable warning
+      // Release the bucket once all 26 lists are empty, so that walks over
+      // the table skip it again
+      if (bucket->itemCount == 0) {
+        bucket.reset();
       }
+      removeScope.Succeed();
       return;
     }
     ++previousIterator;
@@ -162,13 +1561,156 @@ void DataStructure::operator-=(char* itemIdentifier) {
   throw std::runtime_error("Item not found");
 }
 
-// Stream output operator: prints all items in the data structure, one per line.
-std::ostream& operator<<(std::ostream& outputStream, const DataStructure& dataStructure) {
-  for (const auto& bucketEntry : dataStructure.mBuckets) {
-    for (const auto& itemList : bucketEntry.second) {
-      std::for_each(itemList.begin(), itemList.end(),
-                    [&outputStream](const Item& currentItem) { outputStream << currentItem << std::endl; });
+// A deep copy allocates every list exactly for its contents, with the nodes
+// and strings of each list laid out in one run, and re-sizes the ID index.
+void DataStructure::Compact() {
+  DataStructure compacted(*this);
+  *this = std::move(compacted);
+}
+
+// Writes the header, the records of all lists in table order and the string table.
+// Items are sorted by ID within each list so that the snapshot can be binary-searched.
+void DataStructure::SaveSnapshot(const std::string& path) const {
+  using snapshot_format::SnapshotHeader;
+  using snapshot_format::SnapshotRecord;
+
+  SnapshotHeader header{};
+  std::memcpy(header.magic, snapshot_format::MAGIC, sizeof(header.magic));
+  header.version = snapshot_format::VERSION;
+  header.itemCount = static_cast<std::uint32_t>(mItemCount);
+
+  std::vector<SnapshotRecord> records;
+  records.reserve(static_cast<std::size_t>(mItemCount));
+  std::string stringTable;
+  std::vector<const Item*> listItems;
+  for (std::size_t listKey = 0; listKey < snapshot_format::LIST_COUNT; ++listKey) {
+    header.listStarts[listKey] = static_cast<std::uint32_t>(records.size());
+    const auto& bucket = mBuckets[listKey / LETTER_COUNT];
+    if (!bucket) {
+      continue;
+    }
+
+    listItems.clear();
+    forEachListItem(*bucket, listKey % LETTER_COUNT,
+                    [&listItems](const Item& storedItem) { listItems.push_back(&storedItem); });
+    std::sort(listItems.begin(), listItems.end(), [](const Item* left, const Item* right) {
+      return std::strcmp(left->GetID(), right->GetID()) < 0;
+    });
+    for (const Item* storedItem : listItems) {
+      SnapshotRecord record{};
+      if (!item_time::tryPackTime(storedItem->pTime, record.secondsOfDay)) {
+        throw std::runtime_error("Invalid time");
+      }
+      record.code = storedItem->Code;
+      record.idOffset = stringTable.size();
+      record.idLength = static_cast<std::uint32_t>(std::strlen(storedItem->GetID()));
+      stringTable.append(storedItem->GetID(), record.idLength + 1);
+      records.push_back(record);
+    }
+  }
+  header.listStarts[snapshot_format::LIST_COUNT] = static_cast<std::uint32_t>(records.size());
+  header.stringTableOffset = sizeof(SnapshotHeader) + records.size() * sizeof(SnapshotRecord);
+  header.stringTableSize = stringTable.size();
+
+  std::ofstream snapshotFile(path, std::ios::binary | std::ios::trunc);
+  snapshotFile.write(reinterpret_cast<const char*>(&header), sizeof(header));
+  snapshotFile.write(reinterpret_cast<const char*>(records.data()),
+                     static_cast<std::streamsize>(records.size() * sizeof(SnapshotRecord)));
+  snapshotFile.write(stringTable.data(), static_cast<std::streamsize>(stringTable.size()));
+  snapshotFile.close();
+  if (!snapshotFile) {
+    throw std::runtime_error("Cannot write " + path);
+  }
+}
+
+// Builds the new contents straight from the mapped image. The snapshot is
+// validated and free of duplicates, so items are placed without the
+// duplicate check of operator+=.
+void DataStructure::LoadSnapshot(const std::string& path) {
+  const DataStructureSnapshot snapshot(path);
+  DataStructure restored(mOptions);
+  const bool needsIdHash = mOptions.useIdIndex || usesHashedArrays();
+  snapshot.ForEachItem([&restored, needsIdHash](std::size_t firstWordIndex, std::size_t secondWordIndex,
+                                                const ITEM1& snapshotItem) {
+    auto& bucket = restored.mBuckets[firstWordIndex];
+    if (!bucket) {
+      bucket = restored.makeBucket();
+    }
+    const InsertPosition position{bucket.get(), secondWordIndex,
+                                  needsIdHash ? ItemIdIndex::Hash(snapshotItem.pID) : 0};
+    restored.insertItem(position, snapshotItem);
+  });
+  *this = std::move(restored);
+}
+
+// Formats every item straight into the buffer in a single pass over the
+// lists (a second pass just for sizing would double the cache misses of the
+// walk). The buffer starts at an estimate and grows geometrically after that.
+std::size_t DataStructure::Export(std::string& buffer, ExportFormat format) const {
+  std::size_t outputLength = buffer.size();
+  const std::size_t estimatedLength = static_cast<std::size_t>(mItemCount) * estimatedLineLength(format);
+  buffer.resize(std::max(buffer.capacity(), outputLength + CSV_HEADER_LENGTH + estimatedLength));
+  if (format == ExportFormat::Csv) {
+    writeText(CSV_HEADER, CSV_HEADER_LENGTH, &buffer[outputLength]);
+    outputLength += CSV_HEADER_LENGTH;
+  }
+  forEachItem([&buffer, &outputLength, format](const Item& storedItem) {
+    const std::size_t itemLength = formattedLength(storedItem, format);
+    if (outputLength + itemLength > buffer.size()) {
+      buffer.resize(std::max(buffer.size() * 2, outputLength + itemLength));
+    }
+    formatItem(storedItem, format, &buffer[outputLength]);
+    outputLength += itemLength;
+  });
+  buffer.resize(outputLength);
+  return static_cast<std::size_t>(mItemCount);
+}
+
+// Items are formatted into a fixed chunk that is written whenever the next
+// item does not fit; an item longer than a whole chunk is written on its own.
+std::size_t DataStructure::Export(std::ostream& output, ExportFormat format, std::size_t chunkSize) const {
+  std::vector<char> chunk(std::max<std::size_t>(chunkSize, CSV_HEADER_LENGTH));
+  std::size_t chunkLength = 0;
+  auto writeChunk = [&output, &chunk, &chunkLength]() {
+    output.write(chunk.data(), static_cast<std::streamsize>(chunkLength));
+    chunkLength = 0;
+  };
+
+  if (format == ExportFormat::Csv) {
+    writeText(CSV_HEADER, CSV_HEADER_LENGTH, chunk.data());
+    chunkLength = CSV_HEADER_LENGTH;
+  }
+  std::vector<char> longItem;
+  forEachItem([&](const Item& storedItem) {
+    const std::size_t itemLength = formattedLength(storedItem, format);
+    if (chunkLength + itemLength > chunk.size()) {
+      writeChunk();
+    }
+    if (itemLength > chunk.size()) {
+      longItem.resize(itemLength);
+      formatItem(storedItem, format, longItem.data());
+      output.write(longItem.data(), static_cast<std::streamsize>(itemLength));
+      return;
     }
+    formatItem(storedItem, format, chunk.data() + chunkLength);
+    chunkLength += itemLength;
+  });
+  writeChunk();
+  return static_cast<std::size_t>(mItemCount);
+}
+
+std::size_t DataStructure::ExportToFile(const std::string& path, ExportFormat format) const {
+  std::ofstream exportFile(path, std::ios::binary | std::ios::trunc);
+  const std::size_t exportedCount = Export(exportFile, format);
+  exportFile.close();
+  if (!exportFile) {
+    throw std::runtime_error("Cannot write " + path);
   }
+  return exportedCount;
+}
+
+// Stream output operator: prints all items in the data structure, one per line.
+std::ostream& operator<<(std::ostream& outputStream, const DataStructure& dataStructure) {
+  dataStructure.Export(outputStream);
   return outputStream;
 }
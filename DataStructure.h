@@ -1,11 +1,27 @@
 #pragma once
 
+#include "Instrumentation.h"
 #include "Item.h"
+#include "ItemCodeIndex.h"
+#include "ItemIdIndex.h"
+#include "ItemTimeIndex.h"
+#include "NodePool.h"
+#include "StringArena.h"
 
 #include <array>
+#include <cstddef>
+#include <cstdint>
 #include <forward_list>
-#include <map>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <memory_resource>
 #include <ostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+class AsyncItemFetcher;
 
 // =============================================================================
 // DataStructure: A two-level bucketed container for storing Item objects.
@@ -15,45 +31,706 @@
 // (e.g., "Cafe Noir", "Tiffany Blue").
 //
 // Storage organization:
-// - Level 1: A map keyed by the first letter of the first word (A-Z)
+// - Level 1: A flat table of 26 lazily allocated buckets, indexed by the
+//            first letter of the first word (A=0, B=1, ... Z=25)
 // - Level 2: An array of 26 linked lists, indexed by the first letter
 //            of the second word (A=0, B=1, ... Z=25)
 //
-// Example: "Cafe Noir" would be stored at mBuckets['C'][13]
-//          where 'C' is from "Cafe" and 13 is the index for 'N' in "Noir"
+// Example: "Cafe Noir" would be stored at linkedListOf(*mBuckets[2], 13)
+//          where 2 is the index for 'C' in "Cafe" and 13 is the index
+//          for 'N' in "Noir"
+//
+// The second level can instead be kept in contiguous arrays of ID hashes
+// (see Options::bucketLayout); both layouts behave identically otherwise.
 // =============================================================================
 class DataStructure
 {
+public:
+  // How the items of a letter pair are stored.
+  enum class BucketLayout {
+    // A singly linked list of Items: a scan follows one pointer per item.
+    LinkedLists,
+
+    // A packed array of one-byte fingerprints and one of the 64-bit hashes of
+    // the IDs next to an array of item pointers: a scan compares 16 or 32
+    // fingerprints per SIMD instruction and only dereferences items whose
+    // fingerprint and hash match. Items keep their addresses.
+    HashedArrays
+  };
+
+  // Construction-time settings. The defaults give the plain two-level layout.
+  struct Options {
+    // Maintain an additional hash index keyed on the full ID string, so that
+    // exact-match lookup, the duplicate check in operator+= and the search in
+    // operator-= do not depend on the length of the letter-pair lists.
+    bool useIdIndex = false;
+
+    // Store the ID and time strings of added items in a bump-allocated pool
+    // owned by the structure instead of two heap blocks per item. The pool
+    // is freed as a whole by Clear() or the destructor; removing an item
+    // does not give its string memory back.
+    bool useStringArena = false;
+
+    // Storage of the letter-pair lists; the layouts can be A/B compared.
+    BucketLayout bucketLayout = BucketLayout::LinkedLists;
+
+    // Maintain secondary indexes on Code and on the second of the day of
+    // pTime, so that ForEachWithCode and ForEachInTimeRange do not scan all
+    // items. Both are updated by every insertion and removal; the Code and
+    // pTime of a stored item must therefore not be changed.
+    bool useCodeIndex = false;
+    bool useTimeIndex = false;
+
+    // Memory resource for the list nodes of BucketLayout::LinkedLists. By
+    // default (nullptr) every structure allocates them from a NodePool of its
+    // own: adding an item pops a free block instead of calling the heap, and
+    // Clear() and the destructor hand the memory back in whole chunks. A
+    // resource given here must outlive the structure and its copies, and
+    // must be thread-safe if BuildParallel is used (e.g.
+    // std::pmr::new_delete_resource() for one heap allocation per node).
+    std::pmr::memory_resource* nodeResource = nullptr;
+  };
+
+  // Text formats of Export.
+  enum class ExportFormat {
+    // One ID per line, as written by operator<<.
+    Lines,
+
+    // An "ID,Code,Time" header row followed by one row per item. Fields
+    // containing a comma, a quote or a line break are quoted (RFC 4180).
+    Csv,
+
+    // One {"id":...,"code":...,"time":...} JSON object per line.
+    Ndjson
+  };
+
 private:
-  // A Bucket is an array of 26 linked lists (one for each letter A-Z).
+  // Number of letters in the ID alphabet (A-Z).
+  static constexpr std::size_t LETTER_COUNT = 26;
+
+  // The contiguous letter-pair list of BucketLayout::HashedArrays.
+  // idHashes[i] is the hash of items[i]'s ID and fingerprints[i] its
+  // fingerprint_scan::fingerprintOf; the newest item is at the back.
+  struct HashedList {
+    std::vector<std::uint8_t> fingerprints;
+    std::vector<std::uint64_t> idHashes;
+    std::vector<std::unique_ptr<Item>> items;
+  };
+
+  // A letter-pair list of BucketLayout::LinkedLists.
+  using ItemList = std::pmr::forward_list<Item>;
+
+  // A Bucket is an array of 26 lists (one for each letter A-Z).
   // The index corresponds to the first letter of the second word in an item's ID.
-  using Bucket = std::array<std::forward_list<Item>, 26>;
+  // The list lengths and their sum are maintained by operator+= / operator-=
+  // so that counting never has to walk the lists.
+  // The lists themselves are those of the structure's BucketLayout: every
+  // bucket is a LinkedListBucket or a HashedArrayBucket (see makeBucket),
+  // reached through linkedListOf() and hashedListOf().
+  struct Bucket {
+    virtual ~Bucket() = default;
+
+    std::array<int, LETTER_COUNT> listCounts{};
+    int itemCount = 0;
+  };
+
+  struct LinkedListBucket : Bucket {
+    // Creates empty lists whose nodes come from nodeResource.
+    explicit LinkedListBucket(std::pmr::memory_resource* nodeResource);
+
+    std::array<ItemList, LETTER_COUNT> lists;
+  };
+
+  struct HashedArrayBucket : Bucket {
+    std::array<HashedList, LETTER_COUNT> lists;
+  };
+
+  // Return list listIndex of a bucket of BucketLayout::LinkedLists or
+  // BucketLayout::HashedArrays respectively.
+  static ItemList& linkedListOf(Bucket& bucket, std::size_t listIndex) {
+    return static_cast<LinkedListBucket&>(bucket).lists[listIndex];
+  }
+  static const ItemList& linkedListOf(const Bucket& bucket, std::size_t listIndex) {
+    return static_cast<const LinkedListBucket&>(bucket).lists[listIndex];
+  }
+  static HashedList& hashedListOf(Bucket& bucket, std::size_t listIndex) {
+    return static_cast<HashedArrayBucket&>(bucket).lists[listIndex];
+  }
+  static const HashedList& hashedListOf(const Bucket& bucket, std::size_t listIndex) {
+    return static_cast<const HashedArrayBucket&>(bucket).lists[listIndex];
+  }
+
+  // Backing storage for item strings if mOptions.useStringArena is set.
+  // Declared before mBuckets so that it outlives the items pointing into it.
+  StringArena mStringArena;
+
+  // The default node resource, created with the first bucket unless
+  // mOptions.nodeResource is set. It is held by pointer, so that the lists
+  // keep their resource when the buckets are moved to another structure, and
+  // declared before mBuckets so that it outlives the nodes allocated from it.
+  std::unique_ptr<NodePool> mNodePool;
+
+  // Table indexed by the first letter of the first word (A=0, ... Z=25).
+  // A slot stays nullptr until the first item with that initial is added,
+  // and is reset to nullptr when the last one is removed.
+  // Example: mBuckets[2] contains all items whose ID starts with 'C'.
+  std::array<std::unique_ptr<Bucket>, LETTER_COUNT> mBuckets;
+
+  // Total number of items across all buckets.
+  int mItemCount = 0;
+
+  Options mOptions;
+
+  // Full-ID index over the items in mBuckets; used only if mOptions.useIdIndex.
+  ItemIdIndex mIdIndex;
+
+  // Secondary indexes over the items in mBuckets; used only if
+  // mOptions.useCodeIndex and mOptions.useTimeIndex are set.
+  ItemCodeIndex mCodeIndex;
+  ItemTimeIndex mTimeIndex;
+
+  // Re-indexes every stored item in all enabled indexes, e.g. after the
+  // buckets have been copied.
+  void rebuildIndexes();
+
+  bool usesSecondaryIndexes() const { return mOptions.useCodeIndex || mOptions.useTimeIndex; }
+
+  // Operation counters reported by GetStats (see Instrumentation.h). They
+  // belong to this object: copies and moves neither take nor replace them.
+  mutable instrumentation::OperationRecorder mLookupRecorder;
+  instrumentation::OperationRecorder mInsertRecorder;
+  instrumentation::OperationRecorder mRemoveRecorder;
+
+  // GetItem without instrumentation.
+  Item* findItem(std::string_view pID) const;
+
+  // Adds item to the enabled secondary indexes. If that throws, item is
+  // left in none of them.
+  void addToSecondaryIndexes(Item* item);
+
+  // Removes item from the enabled secondary indexes; does nothing for an
+  // index that does not hold it. Never throws.
+  void removeFromSecondaryIndexes(const Item* item);
+
+  bool usesHashedArrays() const { return mOptions.bucketLayout == BucketLayout::HashedArrays; }
+
+  // Returns the resource for new list nodes, creating mNodePool on first use.
+  std::pmr::memory_resource* nodeResource();
+
+  // Allocates an empty bucket of the structure's layout; linked lists
+  // allocate their nodes from nodeResource().
+  std::unique_ptr<Bucket> makeBucket();
+
+  // Calls visitor(item) for every item of one letter-pair list, newest first.
+  template <typename Visitor>
+  void forEachListItem(const Bucket& bucket, std::size_t listIndex, Visitor&& visitor) const;
+
+  // Calls visitor(item) for every item, list by list in table order.
+  template <typename Visitor>
+  void forEachItem(Visitor&& visitor) const;
+
+  // The strategies of GetItems: a pipeline of hash-index probes, and
+  // interleaved scans of the letter-pair lists for either layout.
+  int getItemsFromIdIndex(char** pIDs, int idCount, Item** items) const;
+  int getItemsFromLists(char** pIDs, int idCount, Item** items) const;
+
+  // A non-empty letter-pair list, as handed to a worker thread.
+  struct ListReference {
+    const Bucket* bucket;
+    std::size_t listIndex;
+  };
+
+  // Returns the non-empty lists, longest first.
+  std::vector<ListReference> collectNonEmptyLists() const;
+
+  // Number of workers for taskCount tasks on threadCount threads
+  // (0 means one per hardware thread); at least 1.
+  static std::size_t parallelWorkerCount(unsigned threadCount, std::size_t taskCount);
+
+  // Calls runTask(workerIndex, taskIndex) once for every task index in
+  // [0, taskCount) on workerCount threads, including the calling one, and
+  // returns once all have finished. After a task throws, no further task
+  // is started and the first exception is rethrown.
+  static void runInParallel(std::size_t taskCount, std::size_t workerCount,
+                            const std::function<void(std::size_t, std::size_t)>& runTask);
+
+  // Appends the items of buckets [firstBucket, lastBucket] and, within each,
+  // lists [firstList, lastList] whose ID satisfies isMatch to matches, then
+  // sorts the appended pointers by ID.
+  template <typename Predicate>
+  void collectSorted(std::size_t firstBucket, std::size_t lastBucket, std::size_t firstList, std::size_t lastList,
+                     Predicate&& isMatch, std::vector<const Item*>& matches) const;
+
+  // The candidate searches of the public queries; see ForEachWithPrefix,
+  // ForEachInitialPair and RangeScan.
+  void collectWithPrefix(const char* prefix, std::vector<const Item*>& matches) const;
+  void collectInitialPair(char firstWordInitial, char secondWordInitial, std::vector<const Item*>& matches) const;
+  void collectRange(const char* low, const char* high, std::vector<const Item*>& matches) const;
+
+  // The searches of ForEachWithCode and ForEachInTimeRange, through the
+  // secondary index if it is enabled and by a scan of all items otherwise.
+  void collectWithCode(unsigned long code, std::vector<const Item*>& matches) const;
+  void collectTimeRange(const char* firstTime, const char* lastTime, std::vector<const Item*>& matches) const;
+
+  // Returns the item of the bucket's list listIndex whose ID is pID, or nullptr.
+  // idHash is only used with BucketLayout::HashedArrays and must be ItemIdIndex::Hash(pID).
+  Item* findInList(const Bucket& bucket, std::size_t listIndex, std::string_view pID, std::uint64_t idHash) const;
+
+  // Where a new item goes: its list and, with the ID index or the hashed
+  // layout, the hash of its ID.
+  struct InsertPosition {
+    Bucket* bucket;
+    std::size_t listIndex;
+    std::uint64_t idHash;
+  };
+
+  // Outcome of checking whether an item with a given ID can be added.
+  enum class InsertCheck { Ready, InvalidId, AlreadyExists };
+
+  // Validates a new item's ID and checks that it is not stored yet. On
+  // success, fills in the list to push it to and returns InsertCheck::Ready.
+  InsertCheck checkInsert(const char* pID, InsertPosition& position);
+
+  // Same as checkInsert, but throws std::runtime_error unless the item can be added.
+  InsertPosition prepareInsert(const char* pID);
+
+  // Constructs a new item from source at the front of position's list (with
+  // its strings in mStringArena if enabled), then counts and indexes it.
+  template <typename Source>
+  Item* insertItem(const InsertPosition& position, Source&& source);
+
+  // Constructs a new item from source at the front of position's list, with
+  // its strings in arena if mOptions.useStringArena is set. Neither counts
+  // nor indexes it, so only that list is modified.
+  template <typename Source>
+  Item* constructItem(const InsertPosition& position, StringArena& arena, Source&& source);
+
+  // Unlinks the newest item of position's list and destroys it.
+  void discardNewestItem(const InsertPosition& position);
+
+  // Resets every bucket that holds no item, e.g. one allocated by
+  // checkInsert for an insert that failed afterwards.
+  void releaseEmptyBuckets();
+
+  // Counts and indexes the item just added to the front of position's list.
+  Item* commitInsert(const InsertPosition& position, Item* addedItem);
+
+  // The items of one letter-pair list added by BuildParallel.
+  struct ParallelListBuild;
 
-  // Map from first letter of the first word -> Bucket containing items.
-  // Example: mBuckets['C'] contains all items whose ID starts with 'C'.
-  std::map<char, Bucket> mBuckets;
+  // Adds the items of build to its list, skipping those whose ID is stored
+  // already. Runs on a worker thread: it writes only to that list, build
+  // itself and arena; the counters are left to BuildParallel.
+  void fillParallelList(ParallelListBuild& build, const std::vector<Item>& items, StringArena& arena);
+
+  // Calls visitor(Item&) for each of the items build has added to its list.
+  template <typename Visitor>
+  void forEachNewestItem(const ParallelListBuild& build, Visitor&& visitor);
+
+  // Copies every item of source into the (empty) buckets of this structure,
+  // keeping the list order. Strings go to mStringArena if it is enabled.
+  void copyItemsFrom(const DataStructure& source);
 
 public:
   DataStructure() = default;
   ~DataStructure() = default;
 
+  // Creates an empty data structure with the given settings.
+  explicit DataStructure(const Options& options);
+
+  // Copy constructor: creates a deep copy of all items in the original.
+  DataStructure(const DataStructure& original);
+
+  // Assignment operator: replaces the contents with a deep copy of right.
+  DataStructure& operator=(const DataStructure& right);
+
+  // Move constructor and assignment: take over the buckets of the source,
+  // which is left empty.
+  DataStructure(DataStructure&& source) noexcept;
+  DataStructure& operator=(DataStructure&& source) noexcept;
+
+  // Removes all items and releases the buckets and the string pool.
+  void Clear();
+
   // Returns the total number of items stored in the data structure.
+  // Runs in constant time.
   int GetItemsNumber() const;
 
+  // Returns the number of items whose ID starts with firstWordInitial
+  // (e.g., 'C' for "Cafe Noir"), or 0 if the letter is not in A-Z.
+  // Runs in constant time; intended for monitoring bucket skew.
+  int GetBucketItemsNumber(char firstWordInitial) const;
+
+  // Returns the number of items whose words start with firstWordInitial and
+  // secondWordInitial (e.g., 'C' and 'N' for "Cafe Noir"), or 0 if either
+  // letter is not in A-Z. Runs in constant time.
+  int GetListItemsNumber(char firstWordInitial, char secondWordInitial) const;
+
+  // Forward iterator over all items, list by list in table order and newest
+  // first within a list (the order of operator<<). Any change to the
+  // structure invalidates its iterators.
+  class ConstIterator
+  {
+  public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = Item;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const Item*;
+    using reference = const Item&;
+
+    // An end iterator.
+    ConstIterator() = default;
+
+    reference operator*() const { return *mCurrent; }
+    pointer operator->() const { return mCurrent; }
+
+    ConstIterator& operator++();
+    ConstIterator operator++(int) {
+      ConstIterator previous = *this;
+      ++*this;
+      return previous;
+    }
+
+    bool operator==(const ConstIterator& other) const { return mCurrent == other.mCurrent; }
+    bool operator!=(const ConstIterator& other) const { return mCurrent != other.mCurrent; }
+
+  private:
+    friend class DataStructure;
+
+    // Points at the first item of owner, or is an end iterator if it is empty.
+    explicit ConstIterator(const DataStructure& owner);
+
+    // Moves to the first item of the first non-empty list at or after
+    // (bucketIndex, listIndex) in table order, or to the end.
+    void enterNextList(std::size_t bucketIndex, std::size_t listIndex);
+
+    const DataStructure* mOwner = nullptr;
+    std::size_t mBucketIndex = 0;
+    std::size_t mListIndex = 0;
+    ItemList::const_iterator mListPosition; // BucketLayout::LinkedLists
+    std::size_t mHashedPosition = 0;        // BucketLayout::HashedArrays
+    const Item* mCurrent = nullptr;         // nullptr at the end
+  };
+
+  using const_iterator = ConstIterator;
+
+  ConstIterator begin() const { return ConstIterator(*this); }
+  ConstIterator end() const { return ConstIterator(); }
+
+  // Calls function(const Item&) for every item, with the 26 x 26 lists
+  // spread over threadCount threads (0 means one per hardware thread). All
+  // items of a list are visited by the same thread, but calls for different
+  // lists run concurrently and in no particular order, so function must be
+  // safe to call from several threads. If a call throws, the remaining
+  // lists are skipped and the first exception is rethrown.
+  template <typename Function>
+  void ParallelForEach(Function&& function, unsigned threadCount = 0) const {
+    const std::vector<ListReference> lists = collectNonEmptyLists();
+    runInParallel(lists.size(), parallelWorkerCount(threadCount, lists.size()),
+                  [this, &lists, &function](std::size_t, std::size_t listNumber) {
+                    forEachListItem(*lists[listNumber].bucket, lists[listNumber].listIndex, function);
+                  });
+  }
+
+  // Folds map(item) over all items with combine, in parallel like
+  // ParallelForEach. Each list is reduced into a value of its own, which is
+  // then combined into the running value of its thread; the per-thread
+  // values are combined at the end. combine must therefore be associative
+  // and commutative, and identity must be neutral for it. map and combine
+  // are called from several threads.
+  template <typename Result, typename Map, typename Combine>
+  Result ParallelReduce(Result identity, Map&& map, Combine&& combine, unsigned threadCount = 0) const {
+    // The running value of one thread. Wrapped so that a bool is not packed
+    // into a std::vector<bool> bit, and aligned to a cache line so that
+    // neighbouring threads do not write to the same one.
+    struct alignas(64) WorkerResult {
+      Result value;
+    };
+
+    const std::vector<ListReference> lists = collectNonEmptyLists();
+    const std::size_t workerCount = parallelWorkerCount(threadCount, lists.size());
+    std::vector<WorkerResult> workerResults(workerCount, WorkerResult{identity});
+    runInParallel(lists.size(), workerCount, [&](std::size_t workerIndex, std::size_t listNumber) {
+      Result listResult = identity;
+      forEachListItem(*lists[listNumber].bucket, lists[listNumber].listIndex,
+                      [&listResult, &map, &combine](const Item& storedItem) {
+                        listResult = combine(listResult, map(storedItem));
+                      });
+      Result& workerResult = workerResults[workerIndex].value;
+      workerResult = combine(workerResult, listResult);
+    });
+
+    Result result = identity;
+    for (const WorkerResult& workerResult : workerResults) {
+      result = combine(result, workerResult.value);
+    }
+    return result;
+  }
+
+  // Aggregate of the Code values of all items; see GetCodeStatistics.
+  struct CodeStatistics {
+    std::size_t count = 0;
+    unsigned long long sum = 0;
+    unsigned long minimum = 0; // Only meaningful if count > 0
+    unsigned long maximum = 0;
+  };
+
+  // Returns the number, sum, minimum and maximum of the Code values in one
+  // parallel pass (see ParallelReduce).
+  CodeStatistics GetCodeStatistics(unsigned threadCount = 0) const;
+
+  // Number of list length classes in Stats::listLengthCounts.
+  static constexpr std::size_t LIST_LENGTH_CLASS_COUNT = 33;
+
+  // Snapshot returned by GetStats.
+  struct Stats {
+    // Operation counters. They are only maintained if the program is built
+    // with DATASTRUCTURE_ENABLE_STATS and are all zero otherwise.
+    // - lookups:       GetItem, Contains and every ID of GetItems (succeeded = found)
+    // - inserts:       operator+=, Emplace and every item offered to LoadBulk
+    //                  or BuildParallel (failed = rejected or skipped); bulk
+    //                  loads record their mean time per item
+    // - removes:       operator-= and Remove (failed = invalid ID or not found)
+    // - providerCalls: item source calls of all Items in the process, see
+    //                  Item::GetProviderCallStats
+    instrumentation::OperationStats lookups;
+    instrumentation::OperationStats inserts;
+    instrumentation::OperationStats removes;
+    instrumentation::OperationStats providerCalls;
+
+    // Shape of the table, always available (read from the list counters).
+    std::size_t itemCount = 0;
+    std::size_t allocatedBucketCount = 0;
+    std::array<std::size_t, LETTER_COUNT> bucketItemCounts{}; // By first-word initial
+    std::size_t nonEmptyListCount = 0;                        // Of the 26 x 26 letter-pair lists
+    std::size_t longestListLength = 0;
+
+    // Chain-length distribution over all 26 x 26 lists: listLengthCounts[0]
+    // is the number of empty lists, listLengthCounts[k] that of lists with
+    // a length in [2^(k-1), 2^k).
+    std::array<std::size_t, LIST_LENGTH_CLASS_COUNT> listLengthCounts{};
+  };
+
+  // Returns the operation counters and the current shape of the table, to
+  // spot bucket skew and long lists. Reading the shape takes one pass over
+  // the 26 x 26 list counters; no item is visited.
+  Stats GetStats() const;
+
+  // Sets the operation counters of this structure back to zero (the
+  // provider call counters are process-wide and are kept).
+  void ResetStats();
+
   // Searches for an item by its ID string (e.g., "Cafe Noir").
   // Returns a pointer to the item if found, or nullptr if not found.
   // Note: pID is the item identifier string, not a pointer ID.
   Item *GetItem(char *pID) const;
 
-  // Adds an item to the data structure.
+  // Same as GetItem(char*), for a key that need not be NUL-terminated or
+  // writable (e.g. a std::string or a slice of a larger buffer), so callers
+  // do not have to copy it first. The key is not copied either.
+  Item *GetItem(std::string_view pID) const;
+
+  // Returns true if an item with the given ID is stored.
+  bool Contains(std::string_view pID) const;
+
+  // Looks up idCount IDs at once and stores the result of GetItem(pIDs[i])
+  // in items[i]. Instead of finishing one lookup before starting the next,
+  // the batch interleaves them and prefetches the memory each will read a
+  // few steps ahead, so that the cache misses of different lookups overlap.
+  // Without the ID index, lookups in the same list are also run next to
+  // each other. Returns the number of IDs found.
+  int GetItems(char **pIDs, int idCount, Item **items) const;
+
+  // Ordered queries. Each calls visitor(const Item&) for the matching items
+  // in lexicographic (strcmp) order of their IDs, visiting only the buckets
+  // and lists that can hold a match. Items are passed by reference, not
+  // copied; the lists keep insertion order, so the matches are ordered
+  // through one array of pointers per query. The structure must not be
+  // modified from within the visitor.
+
+  // Visits the items whose ID starts with prefix (e.g., "Ca" or "Cameo P").
+  // A prefix with a space and a following character selects a single list,
+  // otherwise the prefix selects the bucket of its first letter. nullptr or
+  // "" visit every item; a prefix not starting with A-Z visits none.
+  template <typename Visitor>
+  void ForEachWithPrefix(const char* prefix, Visitor&& visitor) const {
+    std::vector<const Item*> matches;
+    collectWithPrefix(prefix, matches);
+    for (const Item* matchingItem : matches) {
+      visitor(*matchingItem);
+    }
+  }
+
+  // Visits the items whose words start with firstWordInitial and
+  // secondWordInitial (e.g., 'C' and 'P' for "Cameo Pink"); none if either
+  // letter is not in A-Z.
+  template <typename Visitor>
+  void ForEachInitialPair(char firstWordInitial, char secondWordInitial, Visitor&& visitor) const {
+    std::vector<const Item*> matches;
+    collectInitialPair(firstWordInitial, secondWordInitial, matches);
+    for (const Item* matchingItem : matches) {
+      visitor(*matchingItem);
+    }
+  }
+
+  // Visits the items with low <= ID < high. nullptr leaves that end of the
+  // range open; only the buckets between the first letters of low and high
+  // are searched.
+  template <typename Visitor>
+  void RangeScan(const char* low, const char* high, Visitor&& visitor) const {
+    std::vector<const Item*> matches;
+    collectRange(low, high, matches);
+    for (const Item* matchingItem : matches) {
+      visitor(*matchingItem);
+    }
+  }
+
+  // Attribute queries. Like the ordered queries, they pass the matching
+  // items by reference and the structure must not be modified from within
+  // the visitor. With the corresponding Options index they only touch the
+  // matches; otherwise every item is examined.
+
+  // Visits the items whose Code equals code, in no particular order.
+  template <typename Visitor>
+  void ForEachWithCode(unsigned long code, Visitor&& visitor) const {
+    std::vector<const Item*> matches;
+    collectWithCode(code, matches);
+    for (const Item* matchingItem : matches) {
+      visitor(*matchingItem);
+    }
+  }
+
+  // Visits the items whose pTime lies between firstTime and lastTime
+  // inclusive (both "hh:mm:ss", e.g. "09:00:00" and "10:30:00"), in order of
+  // time; items with the same time are visited in no particular order.
+  // Visits none if either bound is not a valid time or firstTime is later
+  // than lastTime. Items whose pTime is not a valid time never match.
+  template <typename Visitor>
+  void ForEachInTimeRange(const char* firstTime, const char* lastTime, Visitor&& visitor) const {
+    std::vector<const Item*> matches;
+    collectTimeRange(firstTime, lastTime, matches);
+    for (const Item* matchingItem : matches) {
+      visitor(*matchingItem);
+    }
+  }
+
+  // Adds a copy of an item to the data structure.
   // Throws std::runtime_error if the ID is invalid or item already exists.
   void operator+=(Item& item);
 
-  // Removes an item by its ID string.
+  // Adds an item to the data structure, taking over its strings instead of
+  // copying them. Throws std::runtime_error if the ID is invalid or item
+  // already exists, in which case the item is left unchanged.
+  void operator+=(Item&& item);
+
+  // Fetches the item with the given ID from the data provider and constructs
+  // it directly inside the data structure. Returns the stored item.
+  // Throws std::runtime_error if the ID is invalid or item already exists;
+  // the provider is not called in that case.
+  // Note: pID is the item identifier string, not a pointer ID.
+  Item *Emplace(char *pID);
+
+  // Fetches itemCount random items from the data source with a single
+  // GetStruct1 call and adds them in one pass over the buckets.
+  // Items whose ID is already stored are skipped. Returns the number of
+  // items added. Throws std::runtime_error if the data source fails.
+  // The items are copied; the GetStruct1 structure is never freed, as the
+  // data source allocates it on its own C runtime's heap.
+  int LoadBulk(int itemCount);
+
+  // Adds the items with the given IDs, fetching each from the data provider.
+  // The IDs are validated and grouped by bucket before the first fetch, so
+  // the buckets are visited in one pass. Invalid IDs and IDs that are
+  // already stored (or repeated in pIDs) are skipped. Returns the number of
+  // items added. If a fetch throws, the items added so far are kept.
+  int LoadBulk(char **pIDs, int idCount);
+
+  // Adds the items with the given IDs, fetched by fetcher on its worker
+  // threads. Up to maxInFlight fetches (0 means twice the fetcher's thread
+  // count) are kept outstanding, and each item is inserted on the calling
+  // thread as soon as it arrives, so insertion overlaps the provider's
+  // latency; the resulting list order therefore follows the provider's
+  // completion order. Invalid IDs and IDs that are already stored (or
+  // repeated in pIDs) are skipped, mostly without a fetch. Returns the
+  // number of items added. If a fetch throws, no further fetch is started,
+  // the items added so far are kept, and the first exception is rethrown
+  // once the outstanding fetches have finished.
+  int LoadAsync(char **pIDs, int idCount, AsyncItemFetcher& fetcher, std::size_t maxInFlight = 0);
+
+  // Adds copies of items on up to threadCount threads (0 means one per
+  // hardware thread). The items are partitioned by letter-pair list and each
+  // list is filled by one worker, so the result is the same as adding the
+  // items one after another: items with an invalid ID, or whose ID is
+  // already stored or occurs earlier in items, are skipped. Returns the
+  // number of items added. If an exception is thrown (e.g. std::bad_alloc),
+  // no item is added.
+  int BuildParallel(const std::vector<Item>& items, unsigned threadCount = 0);
+
+  // Removes an item by its ID string. A bucket is released as soon as its
+  // last item is removed.
   // Throws std::runtime_error if the ID is invalid or item not found.
   // Note: pID is the item identifier string, not a pointer ID.
   void operator-=(char *pID);
 
-  // Prints all items in the data structure to the output stream.
+  // Same as operator-=, for a key that need not be NUL-terminated or writable.
+  void Remove(std::string_view pID);
+
+  // Rebuilds the storage into freshly allocated, densely packed lists, the
+  // string pool and the indexes sized for the current items, giving back
+  // the memory and locality lost to removals. Items keep their list order
+  // but not their addresses, so pointers returned by GetItem and Emplace
+  // become invalid. Throws std::bad_alloc if memory runs out, in which case
+  // the structure is unchanged.
+  void Compact();
+
+  // Writes all items to a binary snapshot file (see DataStructureSnapshot.h).
+  // Throws std::runtime_error if the file cannot be written or an item's
+  // time is not formatted as hh:mm:ss.
+  void SaveSnapshot(const std::string& path) const;
+
+  // Replaces the contents with the items of a snapshot file, keeping the
+  // Options of this structure. The order of items within a list may differ
+  // from the saved structure. Throws std::runtime_error if the file cannot
+  // be read or is not a valid snapshot; the contents are unchanged then.
+  void LoadSnapshot(const std::string& path);
+
+  // Appends all items to buffer in the given format, list by list in table
+  // order. The buffer is formatted into in place: it is sized up front for
+  // an estimate of the output and grown geometrically if that is short, so
+  // reusing one buffer across exports avoids reallocating it at all.
+  // Returns the number of items written.
+  std::size_t Export(std::string& buffer, ExportFormat format = ExportFormat::Lines) const;
+
+  // Default chunk size of Export(std::ostream&).
+  static constexpr std::size_t EXPORT_CHUNK_SIZE = 1 << 18;
+
+  // Writes all items to output in the given format, formatting them into a
+  // chunk buffer that is handed to output.write once per chunkSize bytes.
+  // The stream is never flushed. Returns the number of items written.
+  std::size_t Export(std::ostream& output, ExportFormat format = ExportFormat::Lines,
+                     std::size_t chunkSize = EXPORT_CHUNK_SIZE) const;
+
+  // Writes all items to the file at path (replacing it) like Export(ostream&).
+  // Throws std::runtime_error if the file cannot be written.
+  std::size_t ExportToFile(const std::string& path, ExportFormat format = ExportFormat::Lines) const;
+
+  // Prints all items in the data structure to the output stream, one ID per
+  // line, through Export(ostream&); the stream is not flushed per item.
   friend std::ostream &operator<<(std::ostream &ostr, const DataStructure &str);
 };
+
+// Visits the list of the structure's layout; hashed lists keep the newest item
+// at the back, so they are walked backwards to match the linked-list order.
+template <typename Visitor>
+void DataStructure::forEachListItem(const Bucket& bucket, std::size_t listIndex, Visitor&& visitor) const {
+  if (usesHashedArrays()) {
+    const auto& items = hashedListOf(bucket, listIndex).items;
+    for (auto itemIterator = items.rbegin(); itemIterator != items.rend(); ++itemIterator) {
+      visitor(static_cast<const Item&>(**itemIterator));
+    }
+    return;
+  }
+  for (const Item& storedItem : linkedListOf(bucket, listIndex)) {
+    visitor(storedItem);
+  }
+}
@@ -0,0 +1,97 @@
+#include "DataStructureSnapshot.h"
+
+#include <cstring>
+#include <stdexcept>
+
+using snapshot_format::LIST_COUNT;
+using snapshot_format::SnapshotHeader;
+using snapshot_format::SnapshotRecord;
+
+DataStructureSnapshot::ItemView::ItemView(const ItemView& orig) : ITEM1(orig) {
+  std::memcpy(mTimeText, orig.mTimeText, sizeof(mTimeText));
+  pTime = mTimeText;
+}
+
+DataStructureSnapshot::ItemView& DataStructureSnapshot::ItemView::operator=(const ItemView& right) {
+  ITEM1::operator=(right);
+  std::memcpy(mTimeText, right.mTimeText, sizeof(mTimeText));
+  pTime = mTimeText;
+  return *this;
+}
+
+DataStructureSnapshot::DataStructureSnapshot(const std::string& path) : mFile(path) {
+  validate();
+}
+
+// Checks everything GetItem and ForEachItem rely on, in a single pass over the records.
+void DataStructureSnapshot::validate() const {
+  const std::size_t fileSize = mFile.GetSize();
+  if (fileSize < sizeof(SnapshotHeader) || std::memcmp(header().magic, snapshot_format::MAGIC, sizeof(header().magic)) != 0 ||
+      header().version != snapshot_format::VERSION) {
+    throw std::runtime_error("Not a snapshot file");
+  }
+
+  const SnapshotHeader& snapshotHeader = header();
+  const std::uint64_t recordsEnd =
+      sizeof(SnapshotHeader) + static_cast<std::uint64_t>(snapshotHeader.itemCount) * sizeof(SnapshotRecord);
+  if (recordsEnd > fileSize || snapshotHeader.stringTableOffset < recordsEnd ||
+      snapshotHeader.stringTableOffset > fileSize || snapshotHeader.stringTableSize > fileSize - snapshotHeader.stringTableOffset ||
+      snapshotHeader.listStarts[0] != 0 || snapshotHeader.listStarts[LIST_COUNT] != snapshotHeader.itemCount) {
+    throw std::runtime_error("Corrupt snapshot file");
+  }
+
+  for (std::size_t listKey = 0; listKey < LIST_COUNT; ++listKey) {
+    const std::uint32_t listStart = snapshotHeader.listStarts[listKey];
+    const std::uint32_t listEnd = snapshotHeader.listStarts[listKey + 1];
+    if (listEnd < listStart || listEnd > snapshotHeader.itemCount) {
+      throw std::runtime_error("Corrupt snapshot file");
+    }
+    for (std::uint32_t recordIndex = listStart; recordIndex < listEnd; ++recordIndex) {
+      const SnapshotRecord& record = records()[recordIndex];
+      item_identifier::ParsedItemIdentifier parsedIdentifier;
+      if (record.idOffset >= snapshotHeader.stringTableSize ||
+          record.idLength >= snapshotHeader.stringTableSize - record.idOffset || idOf(record)[record.idLength] != '\0' ||
+          std::strlen(idOf(record)) != record.idLength || record.secondsOfDay >= item_time::SECONDS_PER_DAY ||
+          !item_identifier::tryParseItemIdentifier(idOf(record), parsedIdentifier) ||
+          parsedIdentifier.firstWordIndex * item_identifier::LETTER_COUNT + parsedIdentifier.secondWordIndex != listKey ||
+          (recordIndex > listStart && std::strcmp(idOf(records()[recordIndex - 1]), idOf(record)) >= 0)) {
+        throw std::runtime_error("Corrupt snapshot file");
+      }
+    }
+  }
+}
+
+void DataStructureSnapshot::fillView(const SnapshotRecord& record, ItemView& item) const {
+  item.pID = const_cast<char*>(idOf(record));
+  item.Code = static_cast<unsigned long>(record.code);
+  item_time::formatTime(record.secondsOfDay, item.mTimeText);
+  item.pTime = item.mTimeText;
+  item.pNext = nullptr;
+}
+
+// Binary search over the records of the ID's list, which are sorted by ID.
+bool DataStructureSnapshot::GetItem(const char* itemIdentifier, ItemView& item) const {
+  item_identifier::ParsedItemIdentifier parsedIdentifier;
+  if (!item_identifier::tryParseItemIdentifier(itemIdentifier, parsedIdentifier)) {
+    return false;
+  }
+
+  const std::size_t listKey =
+      parsedIdentifier.firstWordIndex * item_identifier::LETTER_COUNT + parsedIdentifier.secondWordIndex;
+  std::uint32_t low = header().listStarts[listKey];
+  std::uint32_t high = header().listStarts[listKey + 1];
+  while (low < high) {
+    const std::uint32_t middle = low + (high - low) / 2;
+    const int comparison = std::strcmp(idOf(records()[middle]), itemIdentifier);
+    if (comparison == 0) {
+      fillView(records()[middle], item);
+      return true;
+    }
+    if (comparison < 0) {
+      low = middle + 1;
+    } else {
+      high = middle;
+    }
+  }
+  return false;
+}
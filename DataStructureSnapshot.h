@@ -0,0 +1,130 @@
+#pragma once
+
+#include "ItemIdentifier.h"
+#include "ItemTime.h"
+#include "Items.h"
+#include "MappedFile.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// =============================================================================
+// Binary snapshots of a DataStructure.
+//
+// DataStructure::SaveSnapshot writes a file with this layout (native byte
+// order, all offsets relative to the start of the file):
+//
+//   SnapshotHeader   magic, version, item count, and for each of the 26 x 26
+//                    letter-pair lists the index of its first record
+//   SnapshotRecord[] one per item, grouped by list (in table order) and
+//                    sorted by ID within a list
+//   string table     the NUL-terminated IDs the records point to
+//
+// Times are stored as seconds since midnight. DataStructureSnapshot maps
+// such a file and answers lookups straight from the mapped image: GetItem
+// finds the ID's list through the header and binary-searches its records,
+// so nothing is deserialized and no item is allocated. DataStructure::
+// LoadSnapshot rebuilds a full structure from the same image.
+// =============================================================================
+
+namespace snapshot_format {
+
+constexpr char MAGIC[8] = {'D', 'S', 'S', 'N', 'A', 'P', '\0', '\0'};
+constexpr std::uint32_t VERSION = 1;
+constexpr std::size_t LIST_COUNT = item_identifier::LETTER_COUNT * item_identifier::LETTER_COUNT;
+
+struct SnapshotHeader {
+  char magic[8];
+  std::uint32_t version;
+  std::uint32_t itemCount;
+  std::uint64_t stringTableOffset;
+  std::uint64_t stringTableSize;
+  // Records of list (first, second) are [listStarts[k], listStarts[k + 1])
+  // with k = first * 26 + second; listStarts[LIST_COUNT] == itemCount.
+  std::uint32_t listStarts[LIST_COUNT + 1];
+};
+
+struct SnapshotRecord {
+  std::uint64_t code;
+  std::uint64_t idOffset;       // Into the string table
+  std::uint32_t idLength;       // Without the terminating NUL
+  std::uint32_t secondsOfDay;
+};
+
+} // namespace snapshot_format
+
+// =============================================================================
+// DataStructureSnapshot: A read-only DataStructure served from a mapped file.
+//
+// Opening validates the whole image (sizes, offsets, ID format, list
+// membership and order), so a truncated or corrupt file is rejected up
+// front instead of failing during lookups.
+// =============================================================================
+class DataStructureSnapshot
+{
+public:
+  // An ITEM1 whose pID points into the mapped file and whose pTime points
+  // into the object itself (re-pointed on copy). Valid while the snapshot
+  // is open; must not be modified. pNext is always nullptr.
+  class ItemView : public ITEM1
+  {
+  public:
+    ItemView() : ITEM1() {}
+    ItemView(const ItemView& orig);
+    ItemView& operator=(const ItemView& right);
+
+  private:
+    friend class DataStructureSnapshot;
+    char mTimeText[item_time::TIME_TEXT_SIZE] = {};
+  };
+
+  // Maps and validates the snapshot file at path.
+  // Throws std::runtime_error if it cannot be read or is not a valid snapshot.
+  explicit DataStructureSnapshot(const std::string& path);
+
+  DataStructureSnapshot(const DataStructureSnapshot&) = delete;
+  DataStructureSnapshot& operator=(const DataStructureSnapshot&) = delete;
+
+  // Returns the total number of items in the snapshot.
+  int GetItemsNumber() const { return static_cast<int>(header().itemCount); }
+
+  // Looks up an item by its ID string. Returns true and fills in item if
+  // found, false if not found or the ID is invalid.
+  bool GetItem(const char* pID, ItemView& item) const;
+
+  // Calls visitor(firstWordIndex, secondWordIndex, item) for every item,
+  // list by list in table order and by ID within a list.
+  template <typename Visitor>
+  void ForEachItem(Visitor&& visitor) const {
+    ItemView item;
+    for (std::size_t listKey = 0; listKey < snapshot_format::LIST_COUNT; ++listKey) {
+      for (std::uint32_t recordIndex = header().listStarts[listKey]; recordIndex < header().listStarts[listKey + 1];
+           ++recordIndex) {
+        fillView(records()[recordIndex], item);
+        visitor(listKey / item_identifier::LETTER_COUNT, listKey % item_identifier::LETTER_COUNT,
+                static_cast<const ITEM1&>(item));
+      }
+    }
+  }
+
+private:
+  const snapshot_format::SnapshotHeader& header() const {
+    return *reinterpret_cast<const snapshot_format::SnapshotHeader*>(mFile.GetData());
+  }
+  const snapshot_format::SnapshotRecord* records() const {
+    return reinterpret_cast<const snapshot_format::SnapshotRecord*>(mFile.GetData() +
+                                                                     sizeof(snapshot_format::SnapshotHeader));
+  }
+  const char* idOf(const snapshot_format::SnapshotRecord& record) const {
+    return mFile.GetData() + header().stringTableOffset + record.idOffset;
+  }
+
+  // Points item at record.
+  void fillView(const snapshot_format::SnapshotRecord& record, ItemView& item) const;
+
+  // Throws std::runtime_error unless the mapped file is a consistent snapshot.
+  void validate() const;
+
+  MappedFile mFile;
+};
@@ -0,0 +1,156 @@
+#include "EpochReclamation.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <limits>
+#include <thread>
+
+namespace {
+
+// Announced epoch of a thread that is not inside an EpochGuard.
+constexpr std::uint64_t INACTIVE_EPOCH = 0;
+
+// Reclamation is attempted once this many nodes are waiting.
+constexpr std::size_t RECLAIM_THRESHOLD = 64;
+
+// Per-thread reader state. Records are never freed; a record released by an
+// exiting thread is reused by the next thread that needs one.
+// Each record gets its own cache line so that readers do not contend.
+struct alignas(64) ThreadRecord {
+  std::atomic<std::uint64_t> announcedEpoch{INACTIVE_EPOCH};
+  std::atomic<bool> isInUse{true};
+  unsigned nestingDepth = 0; // Only touched by the owning thread
+  ThreadRecord* pNext = nullptr;
+};
+
+std::atomic<std::uint64_t> globalEpoch{1};
+std::atomic<ThreadRecord*> threadRecords{nullptr};
+
+// Claims a free record, or adds a new one to the registry.
+ThreadRecord* acquireThreadRecord() {
+  for (ThreadRecord* record = threadRecords.load(std::memory_order_acquire); record; record = record->pNext) {
+    bool isInUse = false;
+    if (!record->isInUse.load(std::memory_order_relaxed) &&
+        record->isInUse.compare_exchange_strong(isInUse, true, std::memory_order_acquire)) {
+      return record;
+    }
+  }
+
+  ThreadRecord* record = new ThreadRecord;
+  record->pNext = threadRecords.load(std::memory_order_relaxed);
+  while (!threadRecords.compare_exchange_weak(record->pNext, record, std::memory_order_release,
+                                              std::memory_order_relaxed)) {
+  }
+  return record;
+}
+
+// Holds the calling thread's record and hands it back when the thread exits.
+struct ThreadRecordOwner {
+  ThreadRecord* record = nullptr;
+
+  ~ThreadRecordOwner() {
+    if (record) {
+      record->isInUse.store(false, std::memory_order_release);
+    }
+  }
+};
+
+ThreadRecord& currentThreadRecord() {
+  thread_local ThreadRecordOwner owner;
+  if (!owner.record) {
+    owner.record = acquireThreadRecord();
+  }
+  return *owner.record;
+}
+
+// Returns the oldest epoch announced by a thread inside an EpochGuard,
+// or the maximum value if no thread is reading.
+std::uint64_t oldestAnnouncedEpoch() {
+  std::uint64_t oldestEpoch = std::numeric_limits<std::uint64_t>::max();
+  for (ThreadRecord* record = threadRecords.load(std::memory_order_acquire); record; record = record->pNext) {
+    const std::uint64_t announcedEpoch = record->announcedEpoch.load(std::memory_order_seq_cst);
+    if (announcedEpoch != INACTIVE_EPOCH) {
+      oldestEpoch = std::min(oldestEpoch, announcedEpoch);
+    }
+  }
+  return oldestEpoch;
+}
+
+} // namespace
+
+// Announces the current epoch. The fence orders the announcement before every
+// later load of a shared node, pairing with the fence in RetiredList::retire.
+EpochGuard::EpochGuard() {
+  ThreadRecord& record = currentThreadRecord();
+  if (record.nestingDepth++ == 0) {
+    record.announcedEpoch.store(globalEpoch.load(std::memory_order_seq_cst), std::memory_order_seq_cst);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+  }
+}
+
+// Withdraws the announcement once the outermost guard ends.
+EpochGuard::~EpochGuard() {
+  ThreadRecord& record = currentThreadRecord();
+  if (--record.nestingDepth == 0) {
+    record.announcedEpoch.store(INACTIVE_EPOCH, std::memory_order_release);
+  }
+}
+
+// Frees every remaining node; no reader may be active on the owner any more.
+RetiredList::~RetiredList() {
+  for (const RetiredNode& retiredNode : mNodes) {
+    retiredNode.deleter(retiredNode.node);
+  }
+}
+
+// Tags the unlinked node with the epoch before advancing it. Any reader that
+// announces a later epoch started after the unlink was published.
+void RetiredList::retire(void* node, void (*deleter)(void*)) {
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  const std::uint64_t retireEpoch = globalEpoch.fetch_add(1, std::memory_order_seq_cst);
+
+  bool isParked = false;
+  bool shouldReclaim = false;
+  {
+    std::lock_guard<std::mutex> lock(mMutex);
+    try {
+      mNodes.push_back(RetiredNode{node, deleter, retireEpoch});
+      isParked = true;
+      shouldReclaim = mNodes.size() >= RECLAIM_THRESHOLD;
+    } catch (...) {
+      // Nowhere to park the node; it is freed below after waiting instead.
+    }
+  }
+
+  if (!isParked) {
+    while (oldestAnnouncedEpoch() <= retireEpoch) {
+      std::this_thread::yield();
+    }
+    deleter(node);
+    return;
+  }
+  if (shouldReclaim) {
+    Reclaim();
+  }
+}
+
+// Frees the retired nodes whose epoch precedes every announced epoch.
+void RetiredList::Reclaim() {
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  const std::uint64_t oldestEpoch = oldestAnnouncedEpoch();
+
+  std::vector<RetiredNode> reclaimableNodes;
+  {
+    std::lock_guard<std::mutex> lock(mMutex);
+    const auto firstKept = std::partition(mNodes.begin(), mNodes.end(), [oldestEpoch](const RetiredNode& retiredNode) {
+      return retiredNode.retireEpoch < oldestEpoch;
+    });
+    reclaimableNodes.assign(mNodes.begin(), firstKept);
+    mNodes.erase(mNodes.begin(), firstKept);
+  }
+
+  for (const RetiredNode& retiredNode : reclaimableNodes) {
+    retiredNode.deleter(retiredNode.node);
+  }
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+// =============================================================================
+// Epoch-based reclamation for lock-free readers.
+//
+// Readers wrap every traversal of shared nodes in an EpochGuard. The guard
+// announces the current global epoch for the calling thread; it costs one
+// store and one fence on a per-thread cache line, and no lock.
+//
+// A writer that has unlinked a node passes it to RetiredList::Retire instead
+// of deleting it. Retiring advances the global epoch and tags the node with
+// the epoch before the advance. The node is freed only once every thread
+// inside an EpochGuard has announced a later epoch; such a reader started
+// after the unlink and can no longer reach the node.
+// =============================================================================
+
+// Marks the calling thread as reading shared nodes for its lifetime.
+// Guards may be nested; only the outermost one announces an epoch.
+class EpochGuard
+{
+public:
+  EpochGuard();
+  ~EpochGuard();
+
+  EpochGuard(const EpochGuard&) = delete;
+  EpochGuard& operator=(const EpochGuard&) = delete;
+};
+
+// Nodes unlinked by writers that wait until no reader can still reach them.
+// Retire and Reclaim are thread-safe. The destructor frees all remaining
+// nodes, so no reader may still be traversing when the list is destroyed.
+class RetiredList
+{
+public:
+  RetiredList() = default;
+  ~RetiredList();
+
+  RetiredList(const RetiredList&) = delete;
+  RetiredList& operator=(const RetiredList&) = delete;
+
+  // Takes ownership of a node that has already been unlinked.
+  // It will be deleted with `delete node` once it is safe to do so.
+  template <typename TNode>
+  void Retire(TNode* node) {
+    retire(node, [](void* retiredNode) { delete static_cast<TNode*>(retiredNode); });
+  }
+
+  // Frees every retired node that no reader can reach any more.
+  void Reclaim();
+
+private:
+  struct RetiredNode {
+    void* node;
+    void (*deleter)(void*);
+    std::uint64_t retireEpoch;
+  };
+
+  void retire(void* node, void (*deleter)(void*));
+
+  std::mutex mMutex;
+  std::vector<RetiredNode> mNodes;
+};
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define FINGERPRINT_SCAN_SSE2
+#endif
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+// =============================================================================
+// Vectorized search in an array of one-byte fingerprints.
+//
+// A container stores a short fingerprint (a few bits of the ID hash) per
+// item in a packed byte array. A lookup compares the wanted fingerprint
+// against 32 (AVX2), 16 (SSE2) or, as a fallback, one entry at a time and
+// only checks the items whose fingerprint matches with a full comparison.
+// With 8-bit fingerprints, about one in 256 non-matching items gets that far.
+//
+// AVX2 is used if the compiler targets it (/arch:AVX2, -mavx2); SSE2 is part
+// of every x64 target.
+// =============================================================================
+
+namespace fingerprint_scan {
+
+// Derives the fingerprint of a 64-bit hash from its top byte, which the
+// bucket and index positions (taken from the low bits) do not use.
+inline std::uint8_t fingerprintOf(std::uint64_t hash) {
+  return static_cast<std::uint8_t>(hash >> 56);
+}
+
+// Returns the index of the lowest set bit of a non-zero mask.
+inline unsigned lowestSetBit(std::uint32_t mask) {
+#if defined(_MSC_VER)
+  unsigned long bitIndex;
+  _BitScanForward(&bitIndex, mask);
+  return static_cast<unsigned>(bitIndex);
+#else
+  return static_cast<unsigned>(__builtin_ctz(mask));
+#endif
+}
+
+// Calls isMatch(i) for every i < count with fingerprints[i] == fingerprint,
+// in ascending order, until it returns true. Returns that i, or count if
+// no candidate matched.
+template <typename Predicate>
+std::size_t findMatch(const std::uint8_t* fingerprints, std::size_t count, std::uint8_t fingerprint,
+                      Predicate&& isMatch) {
+  std::size_t index = 0;
+#if defined(__AVX2__)
+  const __m256i wanted = _mm256_set1_epi8(static_cast<char>(fingerprint));
+  for (; index + 32 <= count; index += 32) {
+    const __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(fingerprints + index));
+    std::uint32_t mask = static_cast<std::uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(block, wanted)));
+    for (; mask != 0; mask &= mask - 1) {
+      const std::size_t candidate = index + lowestSetBit(mask);
+      if (isMatch(candidate)) {
+        return candidate;
+      }
+    }
+  }
+#elif defined(FINGERPRINT_SCAN_SSE2)
+  const __m128i wanted = _mm_set1_epi8(static_cast<char>(fingerprint));
+  for (; index + 16 <= count; index += 16) {
+    const __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(fingerprints + index));
+    std::uint32_t mask = static_cast<std::uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(block, wanted)));
+    for (; mask != 0; mask &= mask - 1) {
+      const std::size_t candidate = index + lowestSetBit(mask);
+      if (isMatch(candidate)) {
+        return candidate;
+      }
+    }
+  }
+#endif
+  for (; index < count; ++index) {
+    if (fingerprints[index] == fingerprint && isMatch(index)) {
+      return index;
+    }
+  }
+  return count;
+}
+
+} // namespace fingerprint_scan
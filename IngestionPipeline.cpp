@@ -0,0 +1,294 @@
+#include "IngestionPipeline.h"
+#include "ItemIdentifier.h"
+
+#include <algorithm>
+#include <condition_variable>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+
+namespace {
+
+// Attempts a stage makes on a full or empty ring, yielding in between,
+// before it goes to sleep on the ring's signal.
+constexpr unsigned SPIN_COUNT = 64;
+
+// Lets the stages on both ends of one ring sleep until the other end has
+// moved. Notify is called after every push and pop; it only takes the
+// mutex when a stage is (about to be) asleep, so a busy ring costs one
+// fence per operation.
+class RingSignal
+{
+public:
+  // Blocks until isReady(), which is evaluated with the mutex held, returns
+  // true. Notify must be called after every change that can make it true.
+  template <typename TPredicate>
+  void WaitUntil(TPredicate&& isReady) {
+    std::unique_lock<std::mutex> lock(mMutex);
+    mSleeperCount.fetch_add(1, std::memory_order_relaxed);
+    // Orders the count before the checks of isReady, against the fence in
+    // Notify: either Notify sees the sleeper, or isReady sees the change.
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    mChanged.wait(lock, isReady);
+    mSleeperCount.fetch_sub(1, std::memory_order_relaxed);
+  }
+
+  // Wakes the stages waiting in WaitUntil, if any.
+  void Notify() {
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (mSleeperCount.load(std::memory_order_relaxed) != 0) {
+      const std::lock_guard<std::mutex> lock(mMutex);
+      mChanged.notify_all();
+    }
+  }
+
+private:
+  std::mutex mMutex;
+  std::condition_variable mChanged;
+  std::atomic<unsigned> mSleeperCount{0};
+};
+
+// Pushes value into the ring of queue. While the ring is full, retries
+// SPIN_COUNT times and then sleeps until the consumer has popped. Returns
+// false without pushing if the run is aborted meanwhile.
+template <typename TQueue, typename TValue>
+bool pushWaiting(TQueue& queue, TValue& value, const std::atomic<bool>& isAborted) {
+  bool isPushed = false;
+  for (unsigned attempt = 0; attempt < SPIN_COUNT && !isPushed; ++attempt) {
+    isPushed = queue.ring.TryPush(value);
+    if (!isPushed) {
+      if (isAborted.load(std::memory_order_acquire)) {
+        return false;
+      }
+      std::this_thread::yield();
+    }
+  }
+  if (!isPushed) {
+    queue.signal.WaitUntil([&]() {
+      isPushed = queue.ring.TryPush(value);
+      return isPushed || isAborted.load(std::memory_order_acquire);
+    });
+  }
+  if (isPushed) {
+    queue.signal.Notify();
+  }
+  return isPushed;
+}
+
+// Pops the next value from the ring of queue, spinning and then sleeping
+// like pushWaiting while the ring is empty. Returns false once the ring is
+// empty and isInputDone is set, or the run is aborted. The stage before
+// sets isInputDone after its last push, so a ring that is still empty after
+// isInputDone was seen will stay empty.
+template <typename TQueue, typename TValue>
+bool popWaiting(TQueue& queue, TValue& value, const std::atomic<bool>& isInputDone,
+                const std::atomic<bool>& isAborted) {
+  bool isPopped = false;
+  bool isStopped = false;
+  const auto tryPop = [&]() {
+    isPopped = queue.ring.TryPop(value);
+    if (!isPopped) {
+      if (isAborted.load(std::memory_order_acquire)) {
+        isStopped = true;
+      } else if (isInputDone.load(std::memory_order_acquire)) {
+        isPopped = queue.ring.TryPop(value);
+        isStopped = !isPopped;
+      }
+    }
+    return isPopped || isStopped;
+  };
+
+  bool isDone = false;
+  for (unsigned attempt = 0; attempt < SPIN_COUNT && !isDone; ++attempt) {
+    isDone = tryPop();
+    if (!isDone) {
+      std::this_thread::yield();
+    }
+  }
+  if (!isDone) {
+    queue.signal.WaitUntil(tryPop);
+  }
+  if (isPopped) {
+    queue.signal.Notify();
+  }
+  return isPopped;
+}
+
+} // namespace
+
+struct IngestionPipeline::Run {
+  // A ring between two stages and the signal its ends sleep on.
+  struct Queue {
+    explicit Queue(std::size_t capacity) : ring(capacity) {}
+
+    RecordRing ring;
+    RingSignal signal;
+  };
+
+  Run(std::size_t queueCapacity, std::size_t shardCount) : parserInput(queueCapacity), shardResults(shardCount) {
+    inserterInputs.reserve(shardCount);
+    for (std::size_t shardIndex = 0; shardIndex < shardCount; ++shardIndex) {
+      inserterInputs.push_back(std::make_unique<Queue>(queueCapacity));
+    }
+  }
+
+  // Keeps the first failure and makes every stage stop.
+  void Abort(std::exception_ptr stageFailure) {
+    {
+      const std::lock_guard<std::mutex> failureLock(failureMutex);
+      if (!failure) {
+        failure = stageFailure;
+      }
+    }
+    isAborted.store(true, std::memory_order_release);
+    parserInput.signal.Notify();
+    for (const std::unique_ptr<Queue>& inserterInput : inserterInputs) {
+      inserterInput->signal.Notify();
+    }
+  }
+
+  Queue parserInput;
+  std::vector<std::unique_ptr<Queue>> inserterInputs; // One per shard
+  std::atomic<bool> isProducerDone{false};
+  std::atomic<bool> isParserDone{false};
+  std::atomic<bool> isAborted{false};
+
+  // Each stage writes only its own counters; they are read after the join.
+  std::size_t invalidCount = 0;
+  std::vector<Result> shardResults;
+
+  std::mutex failureMutex;
+  std::exception_ptr failure;
+};
+
+IngestionPipeline::IngestionPipeline(ConcurrentDataStructure& target) : IngestionPipeline(target, Options()) {}
+
+IngestionPipeline::IngestionPipeline(ConcurrentDataStructure& target, const Options& options)
+    : mTarget(target), mOptions(options) {}
+
+IngestionPipeline::Result IngestionPipeline::RunFromProvider(std::size_t itemCount) {
+  return run([itemCount](auto&& push) {
+    std::size_t producedCount = 0;
+    for (; producedCount < itemCount; ++producedCount) {
+      Record record;
+      record.item = std::make_unique<Item>();
+      if (!push(record)) {
+        break;
+      }
+    }
+    return producedCount;
+  });
+}
+
+// Lines may end in "\r\n" when the file was written on Windows.
+IngestionPipeline::Result IngestionPipeline::RunFromStream(std::istream& ids) {
+  return run([&ids](auto&& push) {
+    std::size_t producedCount = 0;
+    Record record;
+    while (std::getline(ids, record.itemIdentifier)) {
+      if (!record.itemIdentifier.empty() && record.itemIdentifier.back() == '\r') {
+        record.itemIdentifier.pop_back();
+      }
+      if (record.itemIdentifier.empty()) {
+        continue;
+      }
+      if (!push(record)) {
+        break;
+      }
+      ++producedCount;
+    }
+    return producedCount;
+  });
+}
+
+// The calling thread is the producer. If a thread cannot be started, the
+// run is aborted before anything is produced.
+template <typename TProducer>
+IngestionPipeline::Result IngestionPipeline::run(TProducer&& produce) {
+  unsigned shardCount = mOptions.shardCount;
+  if (shardCount == 0) {
+    shardCount = std::max(1u, std::thread::hardware_concurrency());
+  }
+  shardCount = std::min<unsigned>(shardCount, static_cast<unsigned>(item_identifier::LETTER_COUNT));
+  Run run(mOptions.queueCapacity, shardCount);
+
+  std::vector<std::thread> stageThreads;
+  stageThreads.reserve(shardCount + 1);
+  Result result;
+  try {
+    stageThreads.emplace_back([this, &run]() { runParser(run); });
+    for (std::size_t shardIndex = 0; shardIndex < shardCount; ++shardIndex) {
+      stageThreads.emplace_back([this, &run, shardIndex]() { runInserter(run, shardIndex); });
+    }
+    result.produced = produce([&run](Record& record) { return pushWaiting(run.parserInput, record, run.isAborted); });
+  } catch (...) {
+    run.Abort(std::current_exception());
+  }
+  run.isProducerDone.store(true, std::memory_order_release);
+  run.parserInput.signal.Notify();
+  for (std::thread& stageThread : stageThreads) {
+    stageThread.join();
+  }
+  if (run.failure) {
+    std::rethrow_exception(run.failure);
+  }
+
+  result.invalid = run.invalidCount;
+  for (const Result& shardResult : run.shardResults) {
+    result.added += shardResult.added;
+    result.rejected += shardResult.rejected;
+  }
+  return result;
+}
+
+// Shard k takes the letters whose index modulo the shard count is k.
+void IngestionPipeline::runParser(Run& run) {
+  try {
+    Record record;
+    while (popWaiting(run.parserInput, record, run.isProducerDone, run.isAborted)) {
+      const char* itemIdentifier = record.item ? record.item->GetID() : record.itemIdentifier.c_str();
+      item_identifier::ParsedItemIdentifier parsedIdentifier;
+      if (!item_identifier::tryParseItemIdentifier(itemIdentifier, parsedIdentifier)) {
+        ++run.invalidCount;
+        continue;
+      }
+      Run::Queue& inserterInput = *run.inserterInputs[parsedIdentifier.firstWordIndex % run.inserterInputs.size()];
+      if (!pushWaiting(inserterInput, record, run.isAborted)) {
+        break;
+      }
+    }
+  } catch (...) {
+    run.Abort(std::current_exception());
+  }
+  run.isParserDone.store(true, std::memory_order_release);
+  for (const std::unique_ptr<Run::Queue>& inserterInput : run.inserterInputs) {
+    inserterInput->signal.Notify();
+  }
+}
+
+// A std::runtime_error from the target or the provider rejects only the one
+// record (the item exists already, or the provider does not know the ID);
+// anything else aborts the run.
+void IngestionPipeline::runInserter(Run& run, std::size_t shardIndex) {
+  Result shardResult;
+  try {
+    Run::Queue& input = *run.inserterInputs[shardIndex];
+    Record record;
+    while (popWaiting(input, record, run.isParserDone, run.isAborted)) {
+      try {
+        if (record.item) {
+          mTarget += std::move(*record.item);
+        } else {
+          mTarget.Emplace(&record.itemIdentifier[0]);
+        }
+        ++shardResult.added;
+      } catch (const std::runtime_error&) {
+        ++shardResult.rejected;
+      }
+    }
+  } catch (...) {
+    run.Abort(std::current_exception());
+  }
+  run.shardResults[shardIndex] = shardResult;
+}
@@ -0,0 +1,96 @@
+#pragma once
+
+#include "ConcurrentDataStructure.h"
+#include "Item.h"
+#include "SpscRingBuffer.h"
+
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <istream>
+#include <memory>
+#include <string>
+#include <vector>
+
+// =============================================================================
+// IngestionPipeline: Streams items into a ConcurrentDataStructure in stages.
+//
+// A run is split into three stages that work at the same time:
+// 1. The producer (the calling thread) fetches random items from the data
+//    provider, or reads item IDs from a stream, one per line.
+// 2. The parser (one thread) checks each ID with tryParseItemIdentifier,
+//    drops the invalid ones and routes the others by first letter.
+// 3. The inserters (shardCount threads) each own the letters whose index
+//    modulo shardCount is their shard. An inserter adds fetched items, and
+//    fetches the item of each streamed ID itself (see Emplace), so up to
+//    shardCount provider calls are in flight at once.
+//
+// Neighbouring stages are connected by bounded SpscRingBuffers. A stage
+// whose output ring is full waits until the next stage catches up, so a run
+// holds at most queueCapacity * (1 + shardCount) pending records however
+// long the feed is. A waiting stage retries briefly and then sleeps on a
+// condition variable of the ring until the other end moves, so idle stages
+// (e.g. inserters during a slow stream) do not occupy a core. Since each letter has a single inserter, no two writers
+// ever contend for a partition lock of the target; readers may query the
+// target while a run is in progress.
+// =============================================================================
+class IngestionPipeline
+{
+public:
+  struct Options {
+    // Capacity of each ring between two stages (rounded up to a power of two)
+    std::size_t queueCapacity = 1024;
+
+    // Number of inserter threads (0 means one per hardware thread), at most 26
+    unsigned shardCount = 0;
+  };
+
+  // Counters of one run.
+  struct Result {
+    std::size_t produced = 0; // Items fetched or IDs read by the producer
+    std::size_t invalid = 0;  // Dropped by the parser
+    std::size_t added = 0;    // Added to the target
+    std::size_t rejected = 0; // Already in the target, or not found by the provider
+  };
+
+  // Creates a pipeline that adds to target, which must outlive it.
+  explicit IngestionPipeline(ConcurrentDataStructure& target);
+  IngestionPipeline(ConcurrentDataStructure& target, const Options& options);
+
+  IngestionPipeline(const IngestionPipeline&) = delete;
+  IngestionPipeline& operator=(const IngestionPipeline&) = delete;
+
+  // Fetches itemCount random items from the data provider and adds them.
+  // Returns when all of them have passed through the pipeline. If the
+  // provider or a stage throws, the run stops early and rethrows it.
+  Result RunFromProvider(std::size_t itemCount);
+
+  // Reads item IDs from ids, one per line (empty lines are skipped), and
+  // adds the item of each. Returns at the end of the stream. If a stage
+  // throws anything but a rejection, the run stops early and rethrows it.
+  Result RunFromStream(std::istream& ids);
+
+private:
+  // One entry on its way through the pipeline: an item fetched by the
+  // producer, or only the ID of an item that its inserter will fetch.
+  struct Record {
+    std::unique_ptr<Item> item;
+    std::string itemIdentifier;
+  };
+
+  using RecordRing = SpscRingBuffer<Record>;
+
+  // State shared by the threads of one run.
+  struct Run;
+
+  // Starts the parser and inserters, lets produce(push) feed the first
+  // ring, and joins them all again.
+  template <typename TProducer>
+  Result run(TProducer&& produce);
+
+  void runParser(Run& run);
+  void runInserter(Run& run, std::size_t shardIndex);
+
+  ConcurrentDataStructure& mTarget;
+  Options mOptions;
+};
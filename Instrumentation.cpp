@@ -0,0 +1,27 @@
+#include "Instrumentation.h"
+
+#include <algorithm>
+
+namespace instrumentation {
+
+// Walks the buckets until the running count reaches the quantile's rank; the
+// last bucket is open-ended, so only the maximum bounds it.
+std::uint64_t LatencyHistogram::QuantileNanoseconds(double quantile) const {
+  if (count == 0) {
+    return 0;
+  }
+  const double clampedQuantile = std::min(std::max(quantile, 0.0), 1.0);
+  const std::uint64_t rank = std::max<std::uint64_t>(
+      1, static_cast<std::uint64_t>(clampedQuantile * static_cast<double>(count) + 0.5));
+  std::uint64_t runningCount = 0;
+  for (std::size_t bucketIndex = 0; bucketIndex < LATENCY_BUCKET_COUNT; ++bucketIndex) {
+    runningCount += bucketCounts[bucketIndex];
+    if (runningCount >= rank && bucketIndex + 1 < LATENCY_BUCKET_COUNT) {
+      const std::uint64_t bucketEnd = bucketIndex == 0 ? 0 : (std::uint64_t(1) << bucketIndex) - 1;
+      return std::min(bucketEnd, maxNanoseconds);
+    }
+  }
+  return maxNanoseconds;
+}
+
+} // namespace instrumentation
@@ -0,0 +1,199 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#if defined(DATASTRUCTURE_ENABLE_STATS)
+#include <atomic>
+#include <chrono>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#endif
+
+// =============================================================================
+// Operation counters and latency histograms for the hot paths.
+//
+// Instrumentation is compiled in only if DATASTRUCTURE_ENABLE_STATS is
+// defined (e.g. /D DATASTRUCTURE_ENABLE_STATS or -DDATASTRUCTURE_ENABLE_STATS).
+// Otherwise OperationRecorder and StatsStopwatch are empty classes whose
+// member functions do nothing, so the instrumented code compiles to the
+// same instructions as without them and no clock is read.
+//
+// Recording uses relaxed atomic increments, so operations may be recorded
+// from several threads at once (e.g. concurrent lookups under a shared
+// lock). A snapshot taken while operations are recorded is not exact
+// across counters, but every counter in it is a value it actually had.
+// =============================================================================
+
+namespace instrumentation {
+
+#if defined(DATASTRUCTURE_ENABLE_STATS)
+constexpr bool STATS_ENABLED = true;
+#else
+constexpr bool STATS_ENABLED = false;
+#endif
+
+// Number of latency buckets: bucket 0 counts operations that took 0 ns,
+// bucket k counts those in [2^(k-1), 2^k) ns, and the last bucket also takes
+// everything longer (its lower bound is about 275 seconds).
+constexpr std::size_t LATENCY_BUCKET_COUNT = 40;
+
+// A latency distribution with power-of-two buckets.
+struct LatencyHistogram {
+  std::array<std::uint64_t, LATENCY_BUCKET_COUNT> bucketCounts{};
+  std::uint64_t count = 0;
+  std::uint64_t totalNanoseconds = 0;
+  std::uint64_t maxNanoseconds = 0;
+
+  // Returns the mean latency, or 0 if nothing was recorded.
+  double MeanNanoseconds() const {
+    return count == 0 ? 0.0 : static_cast<double>(totalNanoseconds) / static_cast<double>(count);
+  }
+
+  // Returns an upper bound for the given quantile (e.g. 0.99): the end of
+  // the bucket holding it, capped at maxNanoseconds. 0 if nothing was recorded.
+  std::uint64_t QuantileNanoseconds(double quantile) const;
+};
+
+// Counters of one kind of operation.
+struct OperationStats {
+  std::uint64_t succeeded = 0; // E.g. lookup hits, items added
+  std::uint64_t failed = 0;    // E.g. lookup misses, rejected inserts
+  LatencyHistogram latency;    // Per operation
+};
+
+#if defined(DATASTRUCTURE_ENABLE_STATS)
+
+// Returns the latency bucket of a duration.
+inline std::size_t latencyBucketOf(std::uint64_t nanoseconds) {
+  if (nanoseconds == 0) {
+    return 0;
+  }
+#if defined(_MSC_VER)
+  unsigned long highestBit;
+  _BitScanReverse64(&highestBit, nanoseconds);
+  const std::size_t bitWidth = static_cast<std::size_t>(highestBit) + 1;
+#else
+  const std::size_t bitWidth = 64 - static_cast<std::size_t>(__builtin_clzll(nanoseconds));
+#endif
+  return bitWidth < LATENCY_BUCKET_COUNT ? bitWidth : LATENCY_BUCKET_COUNT - 1;
+}
+
+// Measures the time since its construction.
+class StatsStopwatch
+{
+public:
+  StatsStopwatch() : mStart(std::chrono::steady_clock::now()) {}
+
+  std::uint64_t ElapsedNanoseconds() const {
+    return static_cast<std::uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - mStart).count());
+  }
+
+private:
+  std::chrono::steady_clock::time_point mStart;
+};
+
+// Accumulates the OperationStats of one kind of operation.
+class OperationRecorder
+{
+public:
+  // Records succeededCount successful and failedCount failed operations
+  // that took nanosecondsEach each (e.g. the mean of a batch).
+  void Record(std::uint64_t succeededCount, std::uint64_t failedCount, std::uint64_t nanosecondsEach) {
+    const std::uint64_t operationCount = succeededCount + failedCount;
+    if (operationCount == 0) {
+      return;
+    }
+    mSucceeded.fetch_add(succeededCount, std::memory_order_relaxed);
+    mFailed.fetch_add(failedCount, std::memory_order_relaxed);
+    mBucketCounts[latencyBucketOf(nanosecondsEach)].fetch_add(operationCount, std::memory_order_relaxed);
+    mCount.fetch_add(operationCount, std::memory_order_relaxed);
+    mTotalNanoseconds.fetch_add(nanosecondsEach * operationCount, std::memory_order_relaxed);
+    std::uint64_t maxNanoseconds = mMaxNanoseconds.load(std::memory_order_relaxed);
+    while (nanosecondsEach > maxNanoseconds &&
+           !mMaxNanoseconds.compare_exchange_weak(maxNanoseconds, nanosecondsEach, std::memory_order_relaxed)) {
+    }
+  }
+
+  // Records a single operation.
+  void Record(bool succeeded, std::uint64_t nanoseconds) {
+    Record(succeeded ? 1 : 0, succeeded ? 0 : 1, nanoseconds);
+  }
+
+  OperationStats Snapshot() const {
+    OperationStats stats;
+    stats.succeeded = mSucceeded.load(std::memory_order_relaxed);
+    stats.failed = mFailed.load(std::memory_order_relaxed);
+    for (std::size_t bucketIndex = 0; bucketIndex < LATENCY_BUCKET_COUNT; ++bucketIndex) {
+      stats.latency.bucketCounts[bucketIndex] = mBucketCounts[bucketIndex].load(std::memory_order_relaxed);
+    }
+    stats.latency.count = mCount.load(std::memory_order_relaxed);
+    stats.latency.totalNanoseconds = mTotalNanoseconds.load(std::memory_order_relaxed);
+    stats.latency.maxNanoseconds = mMaxNanoseconds.load(std::memory_order_relaxed);
+    return stats;
+  }
+
+  // Sets all counters back to zero.
+  void Reset() {
+    mSucceeded.store(0, std::memory_order_relaxed);
+    mFailed.store(0, std::memory_order_relaxed);
+    for (auto& bucketCount : mBucketCounts) {
+      bucketCount.store(0, std::memory_order_relaxed);
+    }
+    mCount.store(0, std::memory_order_relaxed);
+    mTotalNanoseconds.store(0, std::memory_order_relaxed);
+    mMaxNanoseconds.store(0, std::memory_order_relaxed);
+  }
+
+private:
+  std::atomic<std::uint64_t> mSucceeded{0};
+  std::atomic<std::uint64_t> mFailed{0};
+  std::array<std::atomic<std::uint64_t>, LATENCY_BUCKET_COUNT> mBucketCounts{};
+  std::atomic<std::uint64_t> mCount{0};
+  std::atomic<std::uint64_t> mTotalNanoseconds{0};
+  std::atomic<std::uint64_t> mMaxNanoseconds{0};
+};
+
+#else
+
+class StatsStopwatch
+{
+public:
+  std::uint64_t ElapsedNanoseconds() const { return 0; }
+};
+
+class OperationRecorder
+{
+public:
+  void Record(std::uint64_t, std::uint64_t, std::uint64_t) {}
+  void Record(bool, std::uint64_t) {}
+  OperationStats Snapshot() const { return OperationStats(); }
+  void Reset() {}
+};
+
+#endif
+
+// Records one operation into a recorder when it goes out of scope: as
+// succeeded if Succeed() was called, as failed otherwise (including when
+// an exception leaves the scope), with the time since construction.
+class OperationScope
+{
+public:
+  explicit OperationScope(OperationRecorder& recorder) : mRecorder(recorder) {}
+  OperationScope(const OperationScope&) = delete;
+  OperationScope& operator=(const OperationScope&) = delete;
+
+  ~OperationScope() { mRecorder.Record(mSucceeded, mStopwatch.ElapsedNanoseconds()); }
+
+  void Succeed() { mSucceeded = true; }
+
+private:
+  OperationRecorder& mRecorder;
+  StatsStopwatch mStopwatch;
+  bool mSucceeded = false;
+};
+
+} // namespace instrumentation
@@ -1,9 +1,15 @@
 #pragma once
 
+#include "Instrumentation.h"
 #include "Items.h"
+#include "ProviderCache.h"
 
+#include <cstddef>
 #include <ostream>
 
+class ItemSource;
+class StringArena;
+
 // =============================================================================
 // Item: Represents a single data item with an ID, code, and timestamp.
 //
@@ -14,12 +20,22 @@
 //   - pTime: Pointer to a C-string containing timestamp information
 //   - pNext: Pointer to the next item (used for linked list structures)
 //
-// The Item class adds proper C++ memory management (Rule of Three):
-// constructors, destructor, copy constructor, and assignment operator
-// that handle the dynamically allocated string members.
+// The Item class adds proper C++ memory management (Rule of Five):
+// constructors, destructor, copy and move constructors, and copy and move
+// assignment operators that handle the dynamically allocated string members.
+//
+// The ID-based constructors take their items from the external data provider
+// unless another ItemSource (e.g. a SyntheticItemSource) has been plugged in.
+// They can answer repeated requests for the same ID from an LRU cache of
+// provider results instead of calling the provider again. The cache is
+// shared by all items and disabled by default.
+//
+// An item may instead keep its strings in a StringArena owned by a
+// DataStructure. Such an item does not free its strings; they are released
+// together with the arena.
 // =============================================================================
 
-// Coursework uses ITEM1; adjust to other ITEMn variants if required.
+// Coursework uses ITEM1; TypedItem (TypedItem.h) covers the other ITEMn variants.
 class Item : public ITEM1
 {
 public:
@@ -31,15 +47,36 @@ public:
     // Note: pID here refers to the item identifier string, not "pointer ID".
     explicit Item(char *pID);
 
+    // Arena constructor: fetches an item with the given identifier and places
+    // its strings in the given arena. The arena must outlive the new item.
+    Item(char *pID, StringArena& arena);
+
     // Destructor: frees the dynamically allocated ID and time strings.
     ~Item();
 
     // Copy constructor: creates a deep copy of the source item.
     Item(const Item& orig);
 
+    // Raw copy constructor: creates a deep copy of a plain ITEM1,
+    // e.g. one returned by the data provider.
+    explicit Item(const ITEM1& orig);
+
+    // Arena copy constructor: copies the source item, placing its strings in
+    // the given arena. The arena must outlive the new item.
+    Item(const ITEM1& orig, StringArena& arena);
+
+    // Move constructor: takes over the strings of the source item, which is
+    // left without an ID. Strings that live in an arena are copied instead,
+    // so the new item never depends on an arena it was not created in.
+    Item(Item&& orig);
+
     // Assignment operator: performs a deep copy from the right-hand side item.
     Item& operator=(const Item& right);
 
+    // Move assignment operator: releases the current strings and takes over
+    // those of the right-hand side item (copying them if they live in an arena).
+    Item& operator=(Item&& right);
+
     // Equality operator: two items are equal if they have the same ID string.
     bool operator==(const Item& other) const;
 
@@ -48,4 +85,29 @@ public:
 
     // Returns a pointer to the item's identifier string.
     char* GetID() const { return pID; }
+
+    // Makes the ID-based constructors take their items from source instead of
+    // the data provider; nullptr switches back to the provider. The source
+    // must outlive every construction that may use it. Clears the cache.
+    static void SetItemSource(ItemSource* source);
+
+    // Sets the maximum number of provider results kept in the cache used by
+    // the ID-based constructors. 0 (the default) disables the cache.
+    static void SetProviderCacheCapacity(std::size_t capacity);
+
+    // Returns the hit/miss counters and the fill level of the provider cache.
+    static ProviderCacheStats GetProviderCacheStats();
+
+    // Drops all cached provider results; the counters are kept.
+    static void ClearProviderCache();
+
+    // Returns the number of item source calls made by the ID-based
+    // constructors (cache hits make none), split into those that returned an
+    // item and those that failed, with their latency. All zero unless built
+    // with DATASTRUCTURE_ENABLE_STATS (see Instrumentation.h).
+    static instrumentation::OperationStats GetProviderCallStats();
+
+private:
+    // False if pID and pTime point into a StringArena.
+    bool mOwnsStrings = true;
 };
\ No newline at end of file
@@ -0,0 +1,120 @@
+#include "ItemCodeIndex.h"
+
+namespace {
+
+// Table size used for the first allocation.
+constexpr std::size_t INITIAL_CAPACITY = 64;
+
+// The table grows once it would become more than 3/4 full.
+constexpr std::size_t MAX_LOAD_NUMERATOR = 3;
+constexpr std::size_t MAX_LOAD_DENOMINATOR = 4;
+
+} // namespace
+
+// Codes are often small or sequential, so they are mixed (the SplitMix64
+// finalizer) before the low bits pick the slot.
+std::size_t ItemCodeIndex::homeSlotOf(unsigned long code, std::size_t mask) {
+  std::uint64_t hash = static_cast<std::uint64_t>(code);
+  hash = (hash ^ (hash >> 30)) * 0xbf58476d1ce4e5b9ull;
+  hash = (hash ^ (hash >> 27)) * 0x94d049bb133111ebull;
+  hash ^= hash >> 31;
+  return static_cast<std::size_t>(hash) & mask;
+}
+
+// Equal codes share a probe sequence, so every match lies between the home
+// slot and the next empty slot.
+void ItemCodeIndex::FindAll(unsigned long code, std::vector<const Item*>& matches) const {
+  if (mItemCount == 0) {
+    return;
+  }
+  const std::size_t mask = mSlots.size() - 1;
+  for (std::size_t slotIndex = homeSlotOf(code, mask); mSlots[slotIndex].item; slotIndex = (slotIndex + 1) & mask) {
+    if (mSlots[slotIndex].code == code) {
+      matches.push_back(mSlots[slotIndex].item);
+    }
+  }
+}
+
+// Adds an entry, growing the table first if the load limit would be exceeded.
+void ItemCodeIndex::Insert(Item* item) {
+  if ((mItemCount + 1) * MAX_LOAD_DENOMINATOR > mSlots.size() * MAX_LOAD_NUMERATOR) {
+    rehash(mSlots.empty() ? INITIAL_CAPACITY : mSlots.size() * 2);
+  }
+
+  const std::size_t mask = mSlots.size() - 1;
+  std::size_t slotIndex = homeSlotOf(item->Code, mask);
+  while (mSlots[slotIndex].item) {
+    slotIndex = (slotIndex + 1) & mask;
+  }
+  mSlots[slotIndex].code = item->Code;
+  mSlots[slotIndex].item = item;
+  ++mItemCount;
+}
+
+// Removes an entry and shifts the following entries of its cluster back,
+// so that every remaining entry stays reachable from its home slot.
+bool ItemCodeIndex::Erase(const Item* item) {
+  if (mItemCount == 0) {
+    return false;
+  }
+
+  const std::size_t mask = mSlots.size() - 1;
+  std::size_t holeIndex = homeSlotOf(item->Code, mask);
+  while (mSlots[holeIndex].item != item) {
+    if (!mSlots[holeIndex].item) {
+      return false;
+    }
+    holeIndex = (holeIndex + 1) & mask;
+  }
+
+  std::size_t nextIndex = (holeIndex + 1) & mask;
+  while (mSlots[nextIndex].item) {
+    const std::size_t homeIndex = homeSlotOf(mSlots[nextIndex].code, mask);
+    // The entry may move into the hole only if its home slot does not lie
+    // cyclically within (holeIndex, nextIndex].
+    if (((nextIndex - homeIndex) & mask) >= ((nextIndex - holeIndex) & mask)) {
+      mSlots[holeIndex] = mSlots[nextIndex];
+      holeIndex = nextIndex;
+    }
+    nextIndex = (nextIndex + 1) & mask;
+  }
+  mSlots[holeIndex] = Slot{};
+  --mItemCount;
+  return true;
+}
+
+// Picks the smallest power-of-two table that keeps itemCount entries within the load limit.
+void ItemCodeIndex::Reserve(std::size_t itemCount) {
+  std::size_t slotCount = mSlots.empty() ? INITIAL_CAPACITY : mSlots.size();
+  while (itemCount * MAX_LOAD_DENOMINATOR > slotCount * MAX_LOAD_NUMERATOR) {
+    slotCount *= 2;
+  }
+  if (slotCount != mSlots.size()) {
+    rehash(slotCount);
+  }
+}
+
+// Removes all entries and releases the table.
+void ItemCodeIndex::Clear() {
+  mSlots.clear();
+  mSlots.shrink_to_fit();
+  mItemCount = 0;
+}
+
+// The stored codes are reused, so no item is touched.
+void ItemCodeIndex::rehash(std::size_t slotCount) {
+  std::vector<Slot> oldSlots(slotCount);
+  oldSlots.swap(mSlots);
+
+  const std::size_t mask = mSlots.size() - 1;
+  for (const Slot& oldSlot : oldSlots) {
+    if (!oldSlot.item) {
+      continue;
+    }
+    std::size_t slotIndex = homeSlotOf(oldSlot.code, mask);
+    while (mSlots[slotIndex].item) {
+      slotIndex = (slotIndex + 1) & mask;
+    }
+    mSlots[slotIndex] = oldSlot;
+  }
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include "Item.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// =============================================================================
+// ItemCodeIndex: An open-addressing hash index from Code values to Items.
+//
+// Like ItemIdIndex, the index does not own the items; it stores pointers to
+// Items that live in DataStructure's lists, next to a copy of each item's
+// Code. Codes need not be unique: all items with the same Code share one
+// probe sequence, which a lookup follows up to the next empty slot.
+//
+// Collisions are resolved with linear probing. Erasing uses backward-shift
+// deletion, so the table never accumulates tombstones.
+// =============================================================================
+class ItemCodeIndex
+{
+public:
+  // Returns the number of items in the index.
+  std::size_t Size() const { return mItemCount; }
+
+  // Appends every indexed item whose Code equals code to matches.
+  void FindAll(unsigned long code, std::vector<const Item*>& matches) const;
+
+  // Adds an item under its Code. The caller guarantees that the item
+  // itself is not indexed yet.
+  void Insert(Item* item);
+
+  // Removes the entry of item, looked up under its Code. Returns false if
+  // the item is not indexed.
+  bool Erase(const Item* item);
+
+  // Grows the table so that itemCount entries fit without another rehash.
+  void Reserve(std::size_t itemCount);
+
+  // Removes all entries and releases the table.
+  void Clear();
+
+private:
+  // An empty slot has item == nullptr.
+  struct Slot {
+    unsigned long code = 0;
+    Item* item = nullptr;
+  };
+
+  // Returns the home slot of code in a table of mask + 1 slots.
+  static std::size_t homeSlotOf(unsigned long code, std::size_t mask);
+
+  // Moves all entries into a new table of slotCount slots (a power of two).
+  void rehash(std::size_t slotCount);
+
+  std::vector<Slot> mSlots; // Capacity is always zero or a power of two
+  std::size_t mItemCount = 0;
+};
@@ -0,0 +1,161 @@
+#include "ItemIdIndex.h"
+#include "ItemIdentifier.h"
+#include "MemoryPrefetch.h"
+
+namespace {
+
+constexpr std::uint64_t FNV_OFFSET_BASIS = 14695981039346656037ull;
+constexpr std::uint64_t FNV_PRIME = 1099511628211ull;
+
+// Table size used for the first allocation.
+constexpr std::size_t INITIAL_CAPACITY = 64;
+
+// The table grows once it would become more than 3/4 full.
+constexpr std::size_t MAX_LOAD_NUMERATOR = 3;
+constexpr std::size_t MAX_LOAD_DENOMINATOR = 4;
+
+} // namespace
+
+// Computes the 64-bit FNV-1a hash of a NUL-terminated string.
+std::uint64_t ItemIdIndex::Hash(const char* pID) {
+  std::uint64_t hash = FNV_OFFSET_BASIS;
+  for (const char* current = pID; *current; ++current) {
+    hash ^= static_cast<unsigned char>(*current);
+    hash *= FNV_PRIME;
+  }
+  return hash;
+}
+
+// Same hash, over the characters of a view; equals Hash(const char*) of the same string.
+std::uint64_t ItemIdIndex::Hash(std::string_view pID) {
+  std::uint64_t hash = FNV_OFFSET_BASIS;
+  for (const char letter : pID) {
+    hash ^= static_cast<unsigned char>(letter);
+    hash *= FNV_PRIME;
+  }
+  return hash;
+}
+
+// Walks the probe sequence starting at the hash's home slot until it reaches
+// either the matching entry or an empty slot. Requires a non-empty table.
+std::size_t ItemIdIndex::findSlot(std::string_view pID, std::uint64_t hash) const {
+  const std::size_t mask = mSlots.size() - 1;
+  std::size_t slotIndex = static_cast<std::size_t>(hash) & mask;
+  while (mSlots[slotIndex].item) {
+    const Slot& slot = mSlots[slotIndex];
+    if (slot.hash == hash && item_identifier::identifierEquals(slot.item->GetID(), pID)) {
+      break;
+    }
+    slotIndex = (slotIndex + 1) & mask;
+  }
+  return slotIndex;
+}
+
+// Returns the indexed item with the given ID, or nullptr if there is none.
+Item* ItemIdIndex::Find(std::string_view pID, std::uint64_t hash) const {
+  if (mItemCount == 0) {
+    return nullptr;
+  }
+  return mSlots[findSlot(pID, hash)].item;
+}
+
+void ItemIdIndex::Prefetch(std::uint64_t hash) const {
+  if (!mSlots.empty()) {
+    memory_prefetch::prefetchForRead(&mSlots[static_cast<std::size_t>(hash) & (mSlots.size() - 1)]);
+  }
+}
+
+// Adds an entry, growing the table first if the load limit would be exceeded.
+void ItemIdIndex::Insert(Item* item, std::uint64_t hash) {
+  if ((mItemCount + 1) * MAX_LOAD_DENOMINATOR > mSlots.size() * MAX_LOAD_NUMERATOR) {
+    grow();
+  }
+
+  const std::size_t mask = mSlots.size() - 1;
+  std::size_t slotIndex = static_cast<std::size_t>(hash) & mask;
+  while (mSlots[slotIndex].item) {
+    slotIndex = (slotIndex + 1) & mask;
+  }
+  mSlots[slotIndex].hash = hash;
+  mSlots[slotIndex].item = item;
+  ++mItemCount;
+}
+
+// Removes an entry and shifts the following entries of its cluster back,
+// so that every remaining entry stays reachable from its home slot.
+Item* ItemIdIndex::Erase(std::string_view pID, std::uint64_t hash) {
+  if (mItemCount == 0) {
+    return nullptr;
+  }
+
+  std::size_t holeIndex = findSlot(pID, hash);
+  Item* erasedItem = mSlots[holeIndex].item;
+  if (!erasedItem) {
+    return nullptr;
+  }
+
+  const std::size_t mask = mSlots.size() - 1;
+  std::size_t nextIndex = (holeIndex + 1) & mask;
+  while (mSlots[nextIndex].item) {
+    const std::size_t homeIndex = static_cast<std::size_t>(mSlots[nextIndex].hash) & mask;
+    // The entry may move into the hole only if its home slot does not lie
+    // cyclically within (holeIndex, nextIndex].
+    if (((nextIndex - homeIndex) & mask) >= ((nextIndex - holeIndex) & mask)) {
+      mSlots[holeIndex] = mSlots[nextIndex];
+      holeIndex = nextIndex;
+    }
+    nextIndex = (nextIndex + 1) & mask;
+  }
+  mSlots[holeIndex] = Slot{};
+  --mItemCount;
+  return erasedItem;
+}
+
+void ItemIdIndex::InsertAll(const ItemIdIndex& source) {
+  Reserve(mItemCount + source.mItemCount);
+  for (const Slot& sourceSlot : source.mSlots) {
+    if (sourceSlot.item) {
+      Insert(sourceSlot.item, sourceSlot.hash);
+    }
+  }
+}
+
+// Picks the smallest power-of-two table that keeps itemCount entries within the load limit.
+void ItemIdIndex::Reserve(std::size_t itemCount) {
+  std::size_t slotCount = mSlots.empty() ? INITIAL_CAPACITY : mSlots.size();
+  while (itemCount * MAX_LOAD_DENOMINATOR > slotCount * MAX_LOAD_NUMERATOR) {
+    slotCount *= 2;
+  }
+  if (slotCount != mSlots.size()) {
+    rehash(slotCount);
+  }
+}
+
+// Removes all entries and releases the table.
+void ItemIdIndex::Clear() {
+  mSlots.clear();
+  mSlots.shrink_to_fit();
+  mItemCount = 0;
+}
+
+void ItemIdIndex::grow() {
+  rehash(mSlots.empty() ? INITIAL_CAPACITY : mSlots.size() * 2);
+}
+
+// The stored hashes are reused, so no ID string is touched.
+void ItemIdIndex::rehash(std::size_t slotCount) {
+  std::vector<Slot> oldSlots(slotCount);
+  oldSlots.swap(mSlots);
+
+  const std::size_t mask = mSlots.size() - 1;
+  for (const Slot& oldSlot : oldSlots) {
+    if (!oldSlot.item) {
+      continue;
+    }
+    std::size_t slotIndex = static_cast<std::size_t>(oldSlot.hash) & mask;
+    while (mSlots[slotIndex].item) {
+      slotIndex = (slotIndex + 1) & mask;
+    }
+    mSlots[slotIndex] = oldSlot;
+  }
+}
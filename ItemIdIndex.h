@@ -0,0 +1,78 @@
+#pragma once
+
+#include "Item.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+// =============================================================================
+// ItemIdIndex: An open-addressing hash index from full ID strings to Items.
+//
+// The index does not own the items; it stores pointers to Items that live in
+// DataStructure's lists, together with the 64-bit hash of each item's ID.
+// The stored hash is compared before the ID strings, so a probe only falls
+// back to comparing the strings when the hashes match. Lookups take the ID
+// as a std::string_view, so it need not be NUL-terminated.
+//
+// Collisions are resolved with linear probing. Erasing uses backward-shift
+// deletion, so the table never accumulates tombstones.
+// =============================================================================
+class ItemIdIndex
+{
+public:
+  // Computes the hash of an ID string (64-bit FNV-1a).
+  static std::uint64_t Hash(const char* pID);
+  static std::uint64_t Hash(std::string_view pID);
+
+  // Returns the number of items in the index.
+  std::size_t Size() const { return mItemCount; }
+
+  // Returns the item whose ID equals pID, or nullptr if there is none.
+  // hash must be Hash(pID).
+  Item* Find(std::string_view pID, std::uint64_t hash) const;
+
+  // Starts loading the slot where the probe for hash begins, so that a
+  // Find for the same hash a little later does not wait for memory.
+  void Prefetch(std::uint64_t hash) const;
+
+  // Adds an item under the given hash of its ID.
+  // The caller guarantees that no item with the same ID is indexed.
+  void Insert(Item* item, std::uint64_t hash);
+
+  // Removes the item whose ID equals pID and returns it,
+  // or returns nullptr if there is none. hash must be Hash(pID).
+  Item* Erase(std::string_view pID, std::uint64_t hash);
+
+  // Adds every entry of source, reusing the stored hashes. The caller
+  // guarantees that none of source's IDs is indexed here yet. Does not
+  // allocate if Reserve was called for the combined size.
+  void InsertAll(const ItemIdIndex& source);
+
+  // Grows the table so that itemCount entries fit without another rehash.
+  void Reserve(std::size_t itemCount);
+
+  // Removes all entries and releases the table.
+  void Clear();
+
+private:
+  // An empty slot has item == nullptr.
+  struct Slot {
+    std::uint64_t hash = 0;
+    Item* item = nullptr;
+  };
+
+  // Returns the index of the slot holding pID, or the empty slot
+  // where the probe sequence ended if pID is not indexed.
+  std::size_t findSlot(std::string_view pID, std::uint64_t hash) const;
+
+  // Doubles the table (or allocates the initial one) and reinserts all entries.
+  void grow();
+
+  // Moves all entries into a new table of slotCount slots (a power of two).
+  void rehash(std::size_t slotCount);
+
+  std::vector<Slot> mSlots; // Capacity is always zero or a power of two
+  std::size_t mItemCount = 0;
+};
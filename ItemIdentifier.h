@@ -0,0 +1,83 @@
+#pragma once
+
+#include <cstddef>
+#include <cstring>
+#include <string_view>
+
+// =============================================================================
+// Parsing of item identifiers into their two-level bucket keys.
+//
+// The identifier format is "FirstWord SecondWord" (e.g., "Cafe Noir"), where
+// both words start with an uppercase letter A-Z. The containers index their
+// items first by the initial of the first word and then by the initial of
+// the second word, each mapped to 0-25.
+// =============================================================================
+
+namespace item_identifier {
+
+// Constants for valid uppercase letter range (A-Z)
+constexpr char FIRST_VALID_LETTER = 'A';
+constexpr char LAST_VALID_LETTER = 'Z';
+constexpr char WORD_SEPARATOR = ' ';
+
+// Number of letters in the ID alphabet (A-Z).
+constexpr std::size_t LETTER_COUNT = 26;
+
+// Holds the parsed components of an item identifier.
+struct ParsedItemIdentifier {
+  std::size_t firstWordIndex{};  // Index derived from first letter of first word (0-25)
+  std::size_t secondWordIndex{}; // Index derived from first letter of second word (0-25)
+};
+
+// Converts an uppercase letter into its table index (A=0, ... Z=25).
+// Returns false if the character is not in the range A-Z.
+inline bool tryGetLetterIndex(char letter, std::size_t& letterIndex) {
+  if (letter < FIRST_VALID_LETTER || letter > LAST_VALID_LETTER) {
+    return false;
+  }
+  letterIndex = static_cast<std::size_t>(letter - FIRST_VALID_LETTER);
+  return true;
+}
+
+// Attempts to parse an item identifier string into its bucket keys.
+// Returns true if parsing succeeded, false if the identifier is invalid.
+// Valid format: "FirstWord SecondWord" where both words start with A-Z.
+inline bool tryParseItemIdentifier(const char* itemIdentifier, ParsedItemIdentifier& parsedResult) {
+  if (!itemIdentifier || itemIdentifier[0] == '\0') {
+    return false;
+  }
+
+  const char* spacePosition = std::strchr(itemIdentifier, WORD_SEPARATOR);
+  if (!spacePosition || !spacePosition[1]) {
+    return false;
+  }
+
+  return tryGetLetterIndex(itemIdentifier[0], parsedResult.firstWordIndex) &&
+         tryGetLetterIndex(spacePosition[1], parsedResult.secondWordIndex);
+}
+
+// Same as above for an identifier that need not be NUL-terminated.
+inline bool tryParseItemIdentifier(std::string_view itemIdentifier, ParsedItemIdentifier& parsedResult) {
+  const std::size_t spaceIndex = itemIdentifier.find(WORD_SEPARATOR);
+  if (itemIdentifier.empty() || spaceIndex == std::string_view::npos || spaceIndex + 1 == itemIdentifier.size()) {
+    return false;
+  }
+
+  return tryGetLetterIndex(itemIdentifier[0], parsedResult.firstWordIndex) &&
+         tryGetLetterIndex(itemIdentifier[spaceIndex + 1], parsedResult.secondWordIndex);
+}
+
+// Returns true if the NUL-terminated storedIdentifier equals itemIdentifier.
+// Stops at the first difference, so storedIdentifier is never read past its
+// terminator and its length is never computed.
+inline bool identifierEquals(const char* storedIdentifier, std::string_view itemIdentifier) {
+  for (const char letter : itemIdentifier) {
+    if (*storedIdentifier == '\0' || *storedIdentifier != letter) {
+      return false;
+    }
+    ++storedIdentifier;
+  }
+  return *storedIdentifier == '\0';
+}
+
+} // namespace item_identifier
@@ -0,0 +1,11 @@
+#include "ItemSource.h"
+
+#include "DataProvider.h"
+
+// Asks the data provider for an ITEM1 with the given identifier.
+ITEM1* ProviderItemSource::FetchItem(char* pID) {
+  return static_cast<ITEM1*>(GetItem(1, pID));
+}
+
+// Deliberately leaves the item and its strings allocated; see ProviderItemSource.
+void ProviderItemSource::Release(ITEM1*) {}
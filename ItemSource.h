@@ -0,0 +1,43 @@
+#pragma once
+
+#include "Items.h"
+
+// =============================================================================
+// ItemSource: Where the ID-based Item constructors get their items from.
+//
+// By default items come from GetItem() of the external data provider
+// (ProviderItemSource). Item::SetItemSource() plugs in another source, e.g.
+// a SyntheticItemSource that generates items in-process for load tests.
+//
+// A source hands out plain ITEM1 records that only it knows how to free.
+// Callers copy what they keep and hand each record back through Release of
+// the source that produced it, never freeing it themselves. FetchItem and
+// Release may be called from several threads at once.
+// =============================================================================
+class ItemSource
+{
+public:
+  virtual ~ItemSource() = default;
+
+  // Produces the item with the given identifier, or a random item if pID is
+  // nullptr. The result must be handed back with Release. Throws if no item
+  // can be produced.
+  virtual ITEM1* FetchItem(char* pID) = 0;
+
+  // Hands back an item returned by FetchItem of this source; item must not
+  // be used afterwards. Does nothing if item is nullptr.
+  virtual void Release(ITEM1* item) = 0;
+};
+
+// Item source backed by GetItem() of the external data provider library.
+//
+// The provider allocates its items on the heap of its own DLL, which is
+// linked against another C runtime (the debug ucrtbased), and exports no
+// function to free them. Freeing them from this module would corrupt both
+// heaps, so Release leaves them allocated: every provider item leaks.
+class ProviderItemSource : public ItemSource
+{
+public:
+  ITEM1* FetchItem(char* pID) override;
+  void Release(ITEM1* item) override;
+};
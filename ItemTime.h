@@ -0,0 +1,62 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+// =============================================================================
+// Conversion between the "hh:mm:ss" pTime of ITEM1 and a packed number of
+// seconds since midnight, for storage formats that keep times compactly.
+// =============================================================================
+
+namespace item_time {
+
+constexpr std::uint32_t SECONDS_PER_MINUTE = 60;
+constexpr std::uint32_t SECONDS_PER_HOUR = 60 * SECONDS_PER_MINUTE;
+constexpr std::uint32_t SECONDS_PER_DAY = 24 * SECONDS_PER_HOUR;
+
+// Size of a formatted time including the terminating NUL ("hh:mm:ss").
+constexpr std::size_t TIME_TEXT_SIZE = 9;
+
+namespace detail {
+
+// Reads a two-digit field no larger than maxValue from text.
+inline bool tryParseField(const char* text, std::uint32_t maxValue, std::uint32_t& value) {
+  if (text[0] < '0' || text[0] > '9' || text[1] < '0' || text[1] > '9') {
+    return false;
+  }
+  value = static_cast<std::uint32_t>((text[0] - '0') * 10 + (text[1] - '0'));
+  return value <= maxValue;
+}
+
+} // namespace detail
+
+// Converts "hh:mm:ss" into seconds since midnight.
+// Returns false if timeText is nullptr or has any other format.
+inline bool tryPackTime(const char* timeText, std::uint32_t& secondsOfDay) {
+  std::uint32_t hours;
+  std::uint32_t minutes;
+  std::uint32_t seconds;
+  if (!timeText || std::strlen(timeText) != TIME_TEXT_SIZE - 1 || timeText[2] != ':' || timeText[5] != ':' ||
+      !detail::tryParseField(timeText, 23, hours) || !detail::tryParseField(timeText + 3, 59, minutes) ||
+      !detail::tryParseField(timeText + 6, 59, seconds)) {
+    return false;
+  }
+  secondsOfDay = hours * SECONDS_PER_HOUR + minutes * SECONDS_PER_MINUTE + seconds;
+  return true;
+}
+
+// Writes secondsOfDay (less than SECONDS_PER_DAY) as "hh:mm:ss" with the
+// terminating NUL into timeText.
+inline void formatTime(std::uint32_t secondsOfDay, char (&timeText)[TIME_TEXT_SIZE]) {
+  const std::uint32_t fields[] = {secondsOfDay / SECONDS_PER_HOUR, secondsOfDay / SECONDS_PER_MINUTE % 60,
+                                  secondsOfDay % SECONDS_PER_MINUTE};
+  for (std::size_t fieldIndex = 0; fieldIndex < 3; ++fieldIndex) {
+    timeText[fieldIndex * 3] = static_cast<char>('0' + fields[fieldIndex] / 10);
+    timeText[fieldIndex * 3 + 1] = static_cast<char>('0' + fields[fieldIndex] % 10);
+    timeText[fieldIndex * 3 + 2] = ':';
+  }
+  timeText[TIME_TEXT_SIZE - 1] = '\0';
+}
+
+} // namespace item_time
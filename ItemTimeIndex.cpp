@@ -0,0 +1,51 @@
+#include "ItemTimeIndex.h"
+#include "ItemTime.h"
+
+#include <algorithm>
+
+void ItemTimeIndex::FindRange(std::uint32_t firstSecond, std::uint32_t lastSecond,
+                              std::vector<const Item*>& matches) const {
+  if (mItemCount == 0 || firstSecond > lastSecond || firstSecond >= item_time::SECONDS_PER_DAY) {
+    return;
+  }
+  lastSecond = std::min(lastSecond, item_time::SECONDS_PER_DAY - 1);
+  for (std::uint32_t second = firstSecond; second <= lastSecond; ++second) {
+    matches.insert(matches.end(), mSeconds[second].begin(), mSeconds[second].end());
+  }
+}
+
+bool ItemTimeIndex::Insert(Item* item) {
+  std::uint32_t secondOfDay;
+  if (!item_time::tryPackTime(item->pTime, secondOfDay)) {
+    return false;
+  }
+  if (mSeconds.empty()) {
+    mSeconds.resize(item_time::SECONDS_PER_DAY);
+  }
+  mSeconds[secondOfDay].push_back(item);
+  ++mItemCount;
+  return true;
+}
+
+// The item's array is searched by address; the last entry takes its place.
+bool ItemTimeIndex::Erase(const Item* item) {
+  std::uint32_t secondOfDay;
+  if (mItemCount == 0 || !item_time::tryPackTime(item->pTime, secondOfDay)) {
+    return false;
+  }
+  std::vector<Item*>& secondItems = mSeconds[secondOfDay];
+  const auto erasedItem = std::find(secondItems.begin(), secondItems.end(), item);
+  if (erasedItem == secondItems.end()) {
+    return false;
+  }
+  *erasedItem = secondItems.back();
+  secondItems.pop_back();
+  --mItemCount;
+  return true;
+}
+
+void ItemTimeIndex::Clear() {
+  mSeconds.clear();
+  mSeconds.shrink_to_fit();
+  mItemCount = 0;
+}
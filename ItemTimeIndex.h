@@ -0,0 +1,46 @@
+#pragma once
+
+#include "Item.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// =============================================================================
+// ItemTimeIndex: Items grouped by the second of the day of their pTime.
+//
+// The index keeps one array of item pointers per second since midnight
+// (86400 in total, allocated with the first item), so a time-range query
+// walks the seconds of the range in order and copies out their arrays;
+// no pTime string is parsed during a query. Like ItemIdIndex, the index
+// does not own the items.
+//
+// Items whose pTime is not formatted as "hh:mm:ss" are not indexed.
+// =============================================================================
+class ItemTimeIndex
+{
+public:
+  // Returns the number of items in the index.
+  std::size_t Size() const { return mItemCount; }
+
+  // Appends the indexed items whose time lies in [firstSecond, lastSecond]
+  // (seconds since midnight) to matches, in order of time; items of the same
+  // second are appended in no particular order.
+  void FindRange(std::uint32_t firstSecond, std::uint32_t lastSecond, std::vector<const Item*>& matches) const;
+
+  // Adds an item under the second of its pTime. Returns false, leaving the
+  // index unchanged, if pTime is not a valid time. The caller guarantees
+  // that the item itself is not indexed yet.
+  bool Insert(Item* item);
+
+  // Removes the entry of item, looked up under its pTime. Returns false if
+  // the item is not indexed.
+  bool Erase(const Item* item);
+
+  // Removes all entries and releases the arrays.
+  void Clear();
+
+private:
+  std::vector<std::vector<Item*>> mSeconds; // Empty or one array per second of the day
+  std::size_t mItemCount = 0;
+};
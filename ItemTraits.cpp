@@ -0,0 +1,8 @@
+#include "ItemTraits.h"
+
+#include "DataProvider.h"
+
+// Asks the data provider for an item of the given type.
+void* item_traits_detail::fetchProviderItem(int typeNumber, char* pID) {
+  return GetItem(typeNumber, pID);
+}
@@ -0,0 +1,160 @@
+#pragma once
+
+#include "DateTime.h"
+#include "Items.h"
+
+#include <cstring>
+
+// =============================================================================
+// ItemTraits: Compile-time description of the ITEM1..ITEM10 layouts.
+//
+// The ten item types of Items.h differ only in the member after Code, which
+// holds the time or date of the item in one of several representations:
+// - a C-string (ITEM1 pTime "hh:mm:ss", ITEM4 pDate "dd-mm-yyyy")
+// - a pointer to a TIME, DATE1, DATE2 or DATE3 (ITEM2, 5, 7, 9)
+// - a TIME, DATE1, DATE2 or DATE3 held by value (ITEM3, 6, 8, 10)
+// DATE3 additionally points to the month name.
+//
+// ItemTraits<ITEMn> provides
+// - TYPE_NUMBER: the n to pass to GetItem() of the data provider
+// - CopyPayload / ReleasePayload: deep copy and release of that member
+// - Fetch: typed access to items created by the data provider
+// so that TypedItem and TypedDataStructure can handle any of the layouts
+// without runtime dispatch; all functions are resolved at compile time.
+//
+// Items returned by Fetch stay owned by the data provider: its DLL
+// allocates them on the heap of another C runtime and exports no function
+// to free them, so they are deep-copied and never released. The copies are
+// allocated with new / new[], and ReleasePayload frees only such copies.
+// =============================================================================
+
+namespace item_traits_detail {
+
+// Creates a heap-allocated copy of a C-string; nullptr stays nullptr.
+inline char* duplicateString(const char* source) {
+  if (!source) {
+    return nullptr;
+  }
+  const std::size_t length = std::strlen(source) + 1;
+  char* copy = new char[length];
+  std::memcpy(copy, source, length);
+  return copy;
+}
+
+// Returns GetItem(typeNumber, pID) of the data provider. Kept out of line so
+// that this header does not pull in DataProvider.h.
+void* fetchProviderItem(int typeNumber, char* pID);
+
+// How a payload member of type TPayload is copied and released. Release
+// frees only what Copy allocated. Plain values (TIME, DATE1, DATE2) own
+// nothing and are copied as they are.
+template <typename TPayload>
+struct PayloadOwnership {
+  static void Copy(TPayload& target, const TPayload& source) { target = source; }
+  static void Release(TPayload&) {}
+};
+
+// A C-string allocated with new[].
+template <>
+struct PayloadOwnership<char*> {
+  static void Copy(char*& target, char* const& source) { target = duplicateString(source); }
+  static void Release(char*& payload) {
+    delete[] payload;
+    payload = nullptr;
+  }
+};
+
+// DATE3 by value owns its month name.
+template <>
+struct PayloadOwnership<DATE3> {
+  static void Copy(DATE3& target, const DATE3& source) {
+    target = source;
+    target.pMonth = duplicateString(source.pMonth);
+  }
+  static void Release(DATE3& payload) {
+    delete[] payload.pMonth;
+    payload.pMonth = nullptr;
+  }
+};
+
+// A single object allocated with new, owning whatever its value type owns.
+template <typename TValue>
+struct PayloadOwnership<TValue*> {
+  static void Copy(TValue*& target, TValue* const& source) {
+    target = nullptr;
+    if (source) {
+      TValue* copy = new TValue();
+      try {
+        PayloadOwnership<TValue>::Copy(*copy, *source);
+      } catch (...) {
+        delete copy;
+        throw;
+      }
+      target = copy;
+    }
+  }
+  static void Release(TValue*& payload) {
+    if (payload) {
+      PayloadOwnership<TValue>::Release(*payload);
+      delete payload;
+      payload = nullptr;
+    }
+  }
+};
+
+// Common implementation of the ItemTraits specializations: TItem's payload
+// is the member PayloadMember of type TPayload.
+template <typename TItem, int TypeNumber, typename TPayload, TPayload TItem::*PayloadMember>
+struct ItemTraitsBase {
+  using ItemType = TItem;
+  using PayloadType = TPayload;
+
+  static constexpr int TYPE_NUMBER = TypeNumber;
+
+  // Makes target's payload a deep copy of source's.
+  static void CopyPayload(TItem& target, const TItem& source) {
+    PayloadOwnership<TPayload>::Copy(target.*PayloadMember, source.*PayloadMember);
+  }
+
+  // Frees whatever item's payload owns.
+  static void ReleasePayload(TItem& item) { PayloadOwnership<TPayload>::Release(item.*PayloadMember); }
+
+  // Moves the payload of source into target without copying; source is left
+  // owning nothing.
+  static void TransferPayload(TItem& target, TItem& source) {
+    target.*PayloadMember = source.*PayloadMember;
+    source.*PayloadMember = TPayload();
+  }
+
+  // Fetches an item of this type from the data provider; a random one if pID
+  // is nullptr. The result belongs to the provider and must not be freed or
+  // passed to ReleasePayload; copy what is needed with CopyPayload.
+  static const TItem* Fetch(char* pID) { return static_cast<const TItem*>(fetchProviderItem(TYPE_NUMBER, pID)); }
+};
+
+} // namespace item_traits_detail
+
+// Traits of the item type TItem; defined for ITEM1..ITEM10 only.
+template <typename TItem>
+struct ItemTraits;
+
+template <>
+struct ItemTraits<ITEM1> : item_traits_detail::ItemTraitsBase<ITEM1, 1, char*, &ITEM1::pTime> {};
+template <>
+struct ItemTraits<ITEM2> : item_traits_detail::ItemTraitsBase<ITEM2, 2, TIME*, &ITEM2::pTime> {};
+template <>
+struct ItemTraits<ITEM3> : item_traits_detail::ItemTraitsBase<ITEM3, 3, TIME, &ITEM3::Time> {};
+template <>
+struct ItemTraits<ITEM4> : item_traits_detail::ItemTraitsBase<ITEM4, 4, char*, &ITEM4::pDate> {};
+template <>
+struct ItemTraits<ITEM5> : item_traits_detail::ItemTraitsBase<ITEM5, 5, DATE1*, &ITEM5::pDate> {};
+template <>
+struct ItemTraits<ITEM6> : item_traits_detail::ItemTraitsBase<ITEM6, 6, DATE1, &ITEM6::Date> {};
+template <>
+struct ItemTraits<ITEM7> : item_traits_detail::ItemTraitsBase<ITEM7, 7, DATE2*, &ITEM7::pDate> {};
+template <>
+struct ItemTraits<ITEM8> : item_traits_detail::ItemTraitsBase<ITEM8, 8, DATE2, &ITEM8::Date> {};
+template <>
+struct ItemTraits<ITEM9> : item_traits_detail::ItemTraitsBase<ITEM9, 9, DATE3*, &ITEM9::pDate> {};
+template <>
+struct ItemTraits<ITEM10> : item_traits_detail::ItemTraitsBase<ITEM10, 10, DATE3, &ITEM10::Date> {};
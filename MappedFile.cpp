@@ -0,0 +1,103 @@
+#include "MappedFile.h"
+
+#include <stdexcept>
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifdef _WIN32
+
+MappedFile::MappedFile(const std::string& path) {
+  try {
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                              FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+      throw std::runtime_error("Cannot open " + path);
+    }
+    mFileHandle = file;
+
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(file, &fileSize)) {
+      throw std::runtime_error("Cannot read the size of " + path);
+    }
+    mSize = static_cast<std::size_t>(fileSize.QuadPart);
+    if (mSize == 0) {
+      return;
+    }
+
+    mMappingHandle = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (!mMappingHandle) {
+      throw std::runtime_error("Cannot map " + path);
+    }
+    mData = static_cast<const char*>(MapViewOfFile(mMappingHandle, FILE_MAP_READ, 0, 0, 0));
+    if (!mData) {
+      throw std::runtime_error("Cannot map " + path);
+    }
+  } catch (...) {
+    unmap();
+    throw;
+  }
+}
+
+void MappedFile::unmap() {
+  if (mData) {
+    UnmapViewOfFile(mData);
+  }
+  if (mMappingHandle) {
+    CloseHandle(mMappingHandle);
+  }
+  if (mFileHandle) {
+    CloseHandle(mFileHandle);
+  }
+  mData = nullptr;
+  mMappingHandle = nullptr;
+  mFileHandle = nullptr;
+}
+
+#else
+
+// The descriptor can be closed right after mmap, so no handles are kept.
+MappedFile::MappedFile(const std::string& path) {
+  const int file = open(path.c_str(), O_RDONLY);
+  if (file < 0) {
+    throw std::runtime_error("Cannot open " + path);
+  }
+
+  struct stat fileStatus;
+  if (fstat(file, &fileStatus) != 0) {
+    close(file);
+    throw std::runtime_error("Cannot read the size of " + path);
+  }
+  mSize = static_cast<std::size_t>(fileStatus.st_size);
+  if (mSize == 0) {
+    close(file);
+    return;
+  }
+
+  void* data = mmap(nullptr, mSize, PROT_READ, MAP_PRIVATE, file, 0);
+  close(file);
+  if (data == MAP_FAILED) {
+    throw std::runtime_error("Cannot map " + path);
+  }
+  mData = static_cast<const char*>(data);
+}
+
+void MappedFile::unmap() {
+  if (mData) {
+    munmap(const_cast<char*>(mData), mSize);
+  }
+  mData = nullptr;
+}
+
+#endif
+
+MappedFile::~MappedFile() {
+  unmap();
+}
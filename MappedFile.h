@@ -0,0 +1,36 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+// =============================================================================
+// MappedFile: A read-only memory mapping of a whole file.
+//
+// The file's contents are available through GetData() for the lifetime of
+// the object, without being read into separately allocated memory. Uses
+// CreateFileMapping / MapViewOfFile on Windows and mmap elsewhere. An empty
+// file is valid and has GetData() == nullptr.
+// =============================================================================
+class MappedFile
+{
+public:
+  // Maps the file at path. Throws std::runtime_error if it cannot be opened
+  // or mapped.
+  explicit MappedFile(const std::string& path);
+  ~MappedFile();
+
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+
+  const char* GetData() const { return mData; }
+  std::size_t GetSize() const { return mSize; }
+
+private:
+  // Releases the mapping; safe to call if the constructor failed halfway.
+  void unmap();
+
+  const char* mData = nullptr;
+  std::size_t mSize = 0;
+  void* mFileHandle = nullptr;     // Platform handle of the mapped file
+  void* mMappingHandle = nullptr;  // Platform handle of the mapping object
+};
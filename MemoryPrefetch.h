@@ -0,0 +1,30 @@
+#pragma once
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <xmmintrin.h>
+#endif
+
+// =============================================================================
+// Software prefetch hints for batched lookups.
+//
+// A batch operation that knows which addresses it will read a few steps
+// ahead can ask the CPU to start loading them, so that the cache misses of
+// independent lookups overlap instead of being paid one after another.
+// A prefetch never faults and has no visible effect other than timing; on
+// targets without a prefetch instruction it compiles to nothing.
+// =============================================================================
+
+namespace memory_prefetch {
+
+// Starts loading the cache line holding address into all cache levels.
+inline void prefetchForRead(const void* address) {
+#if defined(__GNUC__) || defined(__clang__)
+  __builtin_prefetch(address, 0, 3);
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+  _mm_prefetch(static_cast<const char*>(address), _MM_HINT_T0);
+#else
+  (void)address;
+#endif
+}
+
+} // namespace memory_prefetch
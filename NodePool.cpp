@@ -0,0 +1,22 @@
+#include "NodePool.h"
+
+void NodePool::Release() {
+  mPool.release();
+}
+
+void* NodePool::do_allocate(std::size_t bytes, std::size_t alignment) {
+  if (mIsShared) {
+    const std::lock_guard<std::mutex> lock(mMutex);
+    return mPool.allocate(bytes, alignment);
+  }
+  return mPool.allocate(bytes, alignment);
+}
+
+void NodePool::do_deallocate(void* block, std::size_t bytes, std::size_t alignment) {
+  if (mIsShared) {
+    const std::lock_guard<std::mutex> lock(mMutex);
+    mPool.deallocate(block, bytes, alignment);
+    return;
+  }
+  mPool.deallocate(block, bytes, alignment);
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <cstddef>
+#include <memory_resource>
+#include <mutex>
+
+// =============================================================================
+// NodePool: The memory resource behind the list nodes of a DataStructure.
+//
+// Blocks come from a std::pmr::unsynchronized_pool_resource, which carves
+// blocks of one size out of larger chunks and keeps freed blocks on a free
+// list. Adding an item to a list therefore pops a block, and removing one
+// pushes it back, without calling the general-purpose heap or taking its
+// lock. The chunks go back to the heap only all at once, through Release()
+// or the destructor.
+//
+// Like the lists that use it, a pool serves one thread at a time. While a
+// SharedScope exists, e.g. for the workers of BuildParallel that fill
+// different lists at once, its allocations are serialized with a mutex.
+// =============================================================================
+class NodePool : public std::pmr::memory_resource
+{
+public:
+  // Makes pool safe to use from several threads until it is destroyed.
+  // Does nothing if pool is nullptr. Must be created and destroyed while
+  // no other thread uses the pool.
+  class SharedScope
+  {
+  public:
+    explicit SharedScope(NodePool* pool) : mPool(pool) {
+      if (mPool) {
+        mPool->mIsShared = true;
+      }
+    }
+    ~SharedScope() {
+      if (mPool) {
+        mPool->mIsShared = false;
+      }
+    }
+    SharedScope(const SharedScope&) = delete;
+    SharedScope& operator=(const SharedScope&) = delete;
+
+  private:
+    NodePool* mPool;
+  };
+
+  NodePool() = default;
+
+  // Nodes allocated from a pool must be returned to it, so it can be
+  // neither copied nor moved; a DataStructure holds it by pointer.
+  NodePool(const NodePool&) = delete;
+  NodePool& operator=(const NodePool&) = delete;
+
+  // Returns all chunks to the heap. Every node allocated before must
+  // already have been destroyed.
+  void Release();
+
+private:
+  void* do_allocate(std::size_t bytes, std::size_t alignment) override;
+  void do_deallocate(void* block, std::size_t bytes, std::size_t alignment) override;
+  bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override { return this == &other; }
+
+  std::pmr::unsynchronized_pool_resource mPool;
+  std::mutex mMutex;     // Taken only while mIsShared is set
+  bool mIsShared = false;
+};
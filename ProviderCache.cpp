@@ -0,0 +1,84 @@
+#include "ProviderCache.h"
+
+// Copies the cached values for pID and moves the entry to the front of the
+// recency list.
+bool ProviderCache::Find(const char* pID, unsigned long& code, std::string& time) {
+  std::lock_guard<std::mutex> lock(mMutex);
+  if (mCapacity == 0 || !pID) {
+    return false;
+  }
+
+  const auto entryIterator = mEntries.find(pID);
+  if (entryIterator == mEntries.end()) {
+    ++mMisses;
+    return false;
+  }
+
+  Entry& entry = entryIterator->second;
+  mRecency.splice(mRecency.begin(), mRecency, entry.recencyPosition);
+  code = entry.code;
+  time = entry.time;
+  ++mHits;
+  return true;
+}
+
+// Adds an entry for the item's ID, or refreshes the existing one.
+void ProviderCache::Insert(const ITEM1& item) {
+  std::lock_guard<std::mutex> lock(mMutex);
+  if (mCapacity == 0 || !item.pID) {
+    return;
+  }
+
+  const auto entryIterator = mEntries.find(item.pID);
+  if (entryIterator != mEntries.end()) {
+    Entry& entry = entryIterator->second;
+    entry.code = item.Code;
+    entry.time = item.pTime ? item.pTime : "";
+    mRecency.splice(mRecency.begin(), mRecency, entry.recencyPosition);
+    return;
+  }
+
+  trimTo(mCapacity - 1);
+  const auto insertedEntry =
+      mEntries.emplace(item.pID, Entry{item.Code, item.pTime ? item.pTime : "", {}}).first;
+  try {
+    mRecency.push_front(&insertedEntry->first);
+  } catch (...) {
+    mEntries.erase(insertedEntry);
+    throw;
+  }
+  insertedEntry->second.recencyPosition = mRecency.begin();
+}
+
+// Changes the maximum number of entries.
+void ProviderCache::SetCapacity(std::size_t capacity) {
+  std::lock_guard<std::mutex> lock(mMutex);
+  mCapacity = capacity;
+  trimTo(capacity);
+}
+
+// Removes all entries.
+void ProviderCache::Clear() {
+  std::lock_guard<std::mutex> lock(mMutex);
+  mEntries.clear();
+  mRecency.clear();
+}
+
+// Returns a consistent snapshot of the counters.
+ProviderCacheStats ProviderCache::GetStats() const {
+  std::lock_guard<std::mutex> lock(mMutex);
+  ProviderCacheStats stats;
+  stats.hits = mHits;
+  stats.misses = mMisses;
+  stats.size = mEntries.size();
+  stats.capacity = mCapacity;
+  return stats;
+}
+
+// Drops entries from the back of the recency list.
+void ProviderCache::trimTo(std::size_t capacity) {
+  while (mEntries.size() > capacity) {
+    mEntries.erase(mEntries.find(*mRecency.back()));
+    mRecency.pop_back();
+  }
+}
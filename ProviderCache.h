@@ -0,0 +1,71 @@
+#pragma once
+
+#include "Items.h"
+
+#include <cstddef>
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+// Counters reported by ProviderCache::GetStats().
+struct ProviderCacheStats {
+  std::size_t hits = 0;      // Lookups answered from the cache
+  std::size_t misses = 0;    // Lookups that had to call the provider
+  std::size_t size = 0;      // Entries currently cached
+  std::size_t capacity = 0;  // Maximum number of entries (0 = disabled)
+};
+
+// =============================================================================
+// ProviderCache: A least-recently-used cache of data provider results.
+//
+// Maps an item ID to the Code and pTime the provider returned for it, so that
+// constructing the same item again does not need another call across the DLL
+// boundary. When the cache is full, the entry used least recently is evicted.
+//
+// A capacity of 0 disables the cache: Find always misses without counting
+// and Insert does nothing. All member functions are thread-safe.
+// =============================================================================
+class ProviderCache
+{
+public:
+  explicit ProviderCache(std::size_t capacity = 0) : mCapacity(capacity) {}
+
+  ProviderCache(const ProviderCache&) = delete;
+  ProviderCache& operator=(const ProviderCache&) = delete;
+
+  // Looks up pID. On a hit, copies the cached values into code and time,
+  // marks the entry as most recently used and returns true.
+  bool Find(const char* pID, unsigned long& code, std::string& time);
+
+  // Stores (or refreshes) the values of item under its ID,
+  // evicting the least recently used entry if the cache is full.
+  void Insert(const ITEM1& item);
+
+  // Changes the maximum number of entries, evicting entries as needed.
+  void SetCapacity(std::size_t capacity);
+
+  // Removes all entries; the hit and miss counters are kept.
+  void Clear();
+
+  // Returns a snapshot of the counters.
+  ProviderCacheStats GetStats() const;
+
+private:
+  struct Entry {
+    unsigned long code;
+    std::string time;
+    std::list<const std::string*>::iterator recencyPosition;
+  };
+
+  // Evicts least recently used entries until at most capacity remain.
+  // The caller holds mMutex.
+  void trimTo(std::size_t capacity);
+
+  mutable std::mutex mMutex;
+  std::unordered_map<std::string, Entry> mEntries;
+  std::list<const std::string*> mRecency; // Keys of mEntries, most recently used first
+  std::size_t mCapacity;
+  std::size_t mHits = 0;
+  std::size_t mMisses = 0;
+};
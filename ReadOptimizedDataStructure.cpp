@@ -0,0 +1,137 @@
+#include "ReadOptimizedDataStructure.h"
+
+#include <stdexcept>
+#include <utility>
+
+using item_identifier::ParsedItemIdentifier;
+using item_identifier::tryParseItemIdentifier;
+
+// Frees the nodes still linked; the retired ones are freed by mRetiredNodes.
+ReadOptimizedDataStructure::~ReadOptimizedDataStructure() {
+  for (auto& bucket : mLists) {
+    for (List& list : bucket) {
+      Node* currentNode = list.head.load(std::memory_order_relaxed);
+      while (currentNode) {
+        Node* nextNode = currentNode->pNext.load(std::memory_order_relaxed);
+        delete currentNode;
+        currentNode = nextNode;
+      }
+    }
+  }
+}
+
+// Copies the item out while the reader is protected from reclamation.
+bool ReadOptimizedDataStructure::CopyItem(const char* itemIdentifier, Item& result) const {
+  return ReadItem(itemIdentifier, [&result](const Item& foundItem) { result = foundItem; });
+}
+
+// Builds the node outside the list and publishes it with a release store,
+// so a reader that sees the new head also sees the complete item.
+void ReadOptimizedDataStructure::insertItem(Item&& itemToAdd) {
+  ParsedItemIdentifier parsedIdentifier;
+  if (!tryParseItemIdentifier(itemToAdd.GetID(), parsedIdentifier)) {
+    throw std::runtime_error("Invalid ID");
+  }
+
+  List& list = mLists[parsedIdentifier.firstWordIndex][parsedIdentifier.secondWordIndex];
+  std::lock_guard<std::mutex> lock(list.writerMutex);
+  Node* const headNode = list.head.load(std::memory_order_relaxed);
+  for (const Node* currentNode = headNode; currentNode;
+       currentNode = currentNode->pNext.load(std::memory_order_relaxed)) {
+    if (std::strcmp(currentNode->item.GetID(), itemToAdd.GetID()) == 0) {
+      throw std::runtime_error("Item already exists");
+    }
+  }
+
+  Node* newNode = new Node(std::move(itemToAdd));
+  newNode->pNext.store(headNode, std::memory_order_relaxed);
+  list.head.store(newNode, std::memory_order_release);
+  mItemCount.fetch_add(1, std::memory_order_relaxed);
+}
+
+// Adds a copy of the item.
+void ReadOptimizedDataStructure::operator+=(const Item& itemToAdd) {
+  insertItem(Item(itemToAdd));
+}
+
+// Moves the item in.
+void ReadOptimizedDataStructure::operator+=(Item&& itemToAdd) {
+  insertItem(std::move(itemToAdd));
+}
+
+// Checks for a duplicate without locking, fetches the item without any lock
+// held, and inserts it, where the duplicate check is repeated under the lock.
+void ReadOptimizedDataStructure::Emplace(char* itemIdentifier) {
+  ParsedItemIdentifier parsedIdentifier;
+  if (!tryParseItemIdentifier(itemIdentifier, parsedIdentifier)) {
+    throw std::runtime_error("Invalid ID");
+  }
+  if (ReadItem(itemIdentifier, [](const Item&) {})) {
+    throw std::runtime_error("Item already exists");
+  }
+  insertItem(Item(itemIdentifier));
+}
+
+// Unlinks the node under the list's writer mutex and retires it, so readers
+// still traversing it can finish safely.
+void ReadOptimizedDataStructure::operator-=(const char* itemIdentifier) {
+  ParsedItemIdentifier parsedIdentifier;
+  if (!tryParseItemIdentifier(itemIdentifier, parsedIdentifier)) {
+    throw std::runtime_error("Invalid ID");
+  }
+
+  List& list = mLists[parsedIdentifier.firstWordIndex][parsedIdentifier.secondWordIndex];
+  Node* removedNode = nullptr;
+  {
+    std::lock_guard<std::mutex> lock(list.writerMutex);
+    std::atomic<Node*>* link = &list.head;
+    for (Node* currentNode = link->load(std::memory_order_relaxed); currentNode;
+         currentNode = link->load(std::memory_order_relaxed)) {
+      if (std::strcmp(currentNode->item.GetID(), itemIdentifier) == 0) {
+        link->store(currentNode->pNext.load(std::memory_order_relaxed), std::memory_order_release);
+        removedNode = currentNode;
+        break;
+      }
+      link = &currentNode->pNext;
+    }
+  }
+
+  if (!removedNode) {
+    throw std::runtime_error("Item not found");
+  }
+  mItemCount.fetch_sub(1, std::memory_order_relaxed);
+  mRetiredNodes.Retire(removedNode);
+}
+
+// Detaches each list in turn and retires all of its nodes.
+void ReadOptimizedDataStructure::Clear() {
+  for (auto& bucket : mLists) {
+    for (List& list : bucket) {
+      Node* detachedNode;
+      {
+        std::lock_guard<std::mutex> lock(list.writerMutex);
+        detachedNode = list.head.exchange(nullptr, std::memory_order_acq_rel);
+      }
+      while (detachedNode) {
+        Node* nextNode = detachedNode->pNext.load(std::memory_order_relaxed);
+        mItemCount.fetch_sub(1, std::memory_order_relaxed);
+        mRetiredNodes.Retire(detachedNode);
+        detachedNode = nextNode;
+      }
+    }
+  }
+}
+
+// Stream output operator: prints all items, one per line.
+std::ostream& operator<<(std::ostream& outputStream, const ReadOptimizedDataStructure& dataStructure) {
+  EpochGuard epochGuard;
+  for (const auto& bucket : dataStructure.mLists) {
+    for (const auto& list : bucket) {
+      for (const auto* currentNode = list.head.load(std::memory_order_acquire); currentNode;
+           currentNode = currentNode->pNext.load(std::memory_order_acquire)) {
+        outputStream << currentNode->item << std::endl;
+      }
+    }
+  }
+  return outputStream;
+}
@@ -0,0 +1,124 @@
+#pragma once
+
+#include "EpochReclamation.h"
+#include "Item.h"
+#include "ItemIdentifier.h"
+
+#include <array>
+#include <atomic>
+#include <cstring>
+#include <mutex>
+#include <ostream>
+
+// =============================================================================
+// ReadOptimizedDataStructure: A DataStructure variant whose lookups take no lock.
+//
+// Items use the same two-level layout as DataStructure (first-word initial,
+// then second-word initial), but every one of the 26x26 lists is a chain of
+// atomically linked nodes:
+// - Readers traverse the lists inside an EpochGuard, without any lock or
+//   read-modify-write on shared memory, so lookup throughput is limited only
+//   by the number of reader cores.
+// - Writers serialize on a mutex per list. A new node is fully built before
+//   it is published with a single release store of the list head, so readers
+//   see either the old or the new list, never a partial node.
+// - A removed node is unlinked with one release store and handed to epoch-
+//   based reclamation. It is freed only after every reader that might still
+//   hold it has left its EpochGuard.
+//
+// Items are returned by copy (CopyItem) or passed to a callback while the
+// reader is protected (ReadItem), because a stored item may be removed and
+// reclaimed as soon as the protection ends.
+// =============================================================================
+class ReadOptimizedDataStructure
+{
+public:
+  ReadOptimizedDataStructure() = default;
+
+  // Frees all items. No other thread may use the structure at this point.
+  ~ReadOptimizedDataStructure();
+
+  // The list heads and writer mutexes can be neither copied nor moved.
+  ReadOptimizedDataStructure(const ReadOptimizedDataStructure&) = delete;
+  ReadOptimizedDataStructure& operator=(const ReadOptimizedDataStructure&) = delete;
+
+  // Returns the total number of items. Runs in constant time without locking;
+  // with concurrent writers the result may already be outdated.
+  int GetItemsNumber() const { return mItemCount.load(std::memory_order_relaxed); }
+
+  // Searches for an item by its ID string without taking a lock. If found,
+  // copies it into result and returns true; otherwise returns false.
+  bool CopyItem(const char *pID, Item& result) const;
+
+  // Searches for an item by its ID string without taking a lock. If found,
+  // calls reader(const Item&) and returns true. The item stays valid until
+  // reader returns, even if another thread removes it meanwhile.
+  template <typename TReader>
+  bool ReadItem(const char *pID, TReader&& reader) const {
+    item_identifier::ParsedItemIdentifier parsedIdentifier;
+    if (!item_identifier::tryParseItemIdentifier(pID, parsedIdentifier)) {
+      return false;
+    }
+
+    EpochGuard epochGuard;
+    const Node* currentNode =
+        mLists[parsedIdentifier.firstWordIndex][parsedIdentifier.secondWordIndex].head.load(std::memory_order_acquire);
+    for (; currentNode; currentNode = currentNode->pNext.load(std::memory_order_acquire)) {
+      if (std::strcmp(currentNode->item.GetID(), pID) == 0) {
+        reader(currentNode->item);
+        return true;
+      }
+    }
+    return false;
+  }
+
+  // Adds a copy of an item to the data structure.
+  // Throws std::runtime_error if the ID is invalid or item already exists.
+  void operator+=(const Item& item);
+
+  // Adds an item to the data structure, taking over its strings.
+  // Throws std::runtime_error if the ID is invalid or item already exists.
+  void operator+=(Item&& item);
+
+  // Fetches the item with the given ID from the data provider and adds it.
+  // The provider is called without holding any lock.
+  // Throws std::runtime_error if the ID is invalid or item already exists.
+  void Emplace(char *pID);
+
+  // Removes an item by its ID string. Readers that are looking at the item
+  // keep a valid copy until they finish.
+  // Throws std::runtime_error if the ID is invalid or item not found.
+  void operator-=(const char *pID);
+
+  // Removes all items, locking one list at a time.
+  void Clear();
+
+  // Prints all items without locking. Items added or removed concurrently
+  // may or may not be printed.
+  friend std::ostream &operator<<(std::ostream &ostr, const ReadOptimizedDataStructure &str);
+
+private:
+  static constexpr std::size_t LETTER_COUNT = item_identifier::LETTER_COUNT;
+
+  // An item together with the link to the next node of its list.
+  // The item is never modified after the node is published.
+  struct Node {
+    explicit Node(Item&& nodeItem) : item(std::move(nodeItem)) {}
+
+    Item item;
+    std::atomic<Node*> pNext{nullptr};
+  };
+
+  // The head of one letter-pair list and the mutex serializing its writers.
+  struct List {
+    std::atomic<Node*> head{nullptr};
+    std::mutex writerMutex;
+  };
+
+  // Inserts a new node for item at the head of its list.
+  void insertItem(Item&& item);
+
+  std::array<std::array<List, LETTER_COUNT>, LETTER_COUNT> mLists;
+  std::atomic<int> mItemCount{0};
+  RetiredList mRetiredNodes;
+};
@@ -0,0 +1,205 @@
+#include "ShardedDataStructure.h"
+#include "ItemIdIndex.h"
+#include "ItemIdentifier.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+namespace {
+
+constexpr std::size_t LETTER_COUNT = item_identifier::LETTER_COUNT;
+
+} // namespace
+
+// The pairs are dealt round-robin in key order, so neighbouring pairs (which
+// tend to be filled alike) start out on different shards.
+ShardedDataStructure::ShardedDataStructure(std::size_t shardCount, Routing routing,
+                                           const DataStructure::Options& options)
+    : mRouting(routing) {
+  if (shardCount == 0 || shardCount > PAIR_COUNT) {
+    throw std::runtime_error("Invalid shard count");
+  }
+  mShards.reserve(shardCount);
+  for (std::size_t shardIndex = 0; shardIndex < shardCount; ++shardIndex) {
+    mShards.emplace_back(options);
+  }
+  for (std::size_t pairKey = 0; pairKey < PAIR_COUNT; ++pairKey) {
+    mPairShards[pairKey] = static_cast<std::uint16_t>(pairKey % shardCount);
+  }
+}
+
+bool ShardedDataStructure::tryGetPairKey(std::string_view itemIdentifier, std::size_t& pairKey) {
+  item_identifier::ParsedItemIdentifier parsedIdentifier;
+  if (!item_identifier::tryParseItemIdentifier(itemIdentifier, parsedIdentifier)) {
+    return false;
+  }
+  pairKey = parsedIdentifier.firstWordIndex * LETTER_COUNT + parsedIdentifier.secondWordIndex;
+  return true;
+}
+
+// Both routings reject the IDs that DataStructure would reject.
+bool ShardedDataStructure::TryGetShardIndex(std::string_view itemIdentifier, std::size_t& shardIndex) const {
+  std::size_t pairKey;
+  if (!tryGetPairKey(itemIdentifier, pairKey)) {
+    return false;
+  }
+  shardIndex = mRouting == Routing::InitialPair
+                   ? mPairShards[pairKey]
+                   : static_cast<std::size_t>(ItemIdIndex::Hash(itemIdentifier) % mShards.size());
+  return true;
+}
+
+DataStructure& ShardedDataStructure::getShard(std::string_view itemIdentifier) {
+  std::size_t shardIndex;
+  if (!TryGetShardIndex(itemIdentifier, shardIndex)) {
+    throw std::runtime_error("Invalid ID");
+  }
+  return mShards[shardIndex];
+}
+
+int ShardedDataStructure::GetItemsNumber() const {
+  int itemCount = 0;
+  for (const DataStructure& shard : mShards) {
+    itemCount += shard.GetItemsNumber();
+  }
+  return itemCount;
+}
+
+double ShardedDataStructure::GetImbalance() const {
+  int largestItemCount = 0;
+  for (const DataStructure& shard : mShards) {
+    largestItemCount = std::max(largestItemCount, shard.GetItemsNumber());
+  }
+  const int itemCount = GetItemsNumber();
+  if (itemCount == 0) {
+    return 1.0;
+  }
+  return static_cast<double>(largestItemCount) * static_cast<double>(mShards.size()) / static_cast<double>(itemCount);
+}
+
+// A null pID is treated like the empty ID, which is invalid.
+Item* ShardedDataStructure::GetItem(char* itemIdentifier) const {
+  return GetItem(itemIdentifier ? std::string_view(itemIdentifier) : std::string_view());
+}
+
+Item* ShardedDataStructure::GetItem(std::string_view itemIdentifier) const {
+  std::size_t shardIndex;
+  if (!TryGetShardIndex(itemIdentifier, shardIndex)) {
+    return nullptr;
+  }
+  return mShards[shardIndex].GetItem(itemIdentifier);
+}
+
+bool ShardedDataStructure::Contains(std::string_view itemIdentifier) const {
+  return GetItem(itemIdentifier) != nullptr;
+}
+
+void ShardedDataStructure::operator+=(Item& itemToAdd) {
+  getShard(itemToAdd.GetID() ? std::string_view(itemToAdd.GetID()) : std::string_view()) += itemToAdd;
+}
+
+void ShardedDataStructure::operator+=(Item&& itemToAdd) {
+  getShard(itemToAdd.GetID() ? std::string_view(itemToAdd.GetID()) : std::string_view()) += std::move(itemToAdd);
+}
+
+void ShardedDataStructure::operator-=(char* itemIdentifier) {
+  Remove(itemIdentifier ? std::string_view(itemIdentifier) : std::string_view());
+}
+
+void ShardedDataStructure::Remove(std::string_view itemIdentifier) {
+  getShard(itemIdentifier).Remove(itemIdentifier);
+}
+
+// Each move takes an item count c from the fullest shard (count M) to the
+// emptiest (count m) with 0 < c < M - m, so both end up strictly between m
+// and M; the sum of the squared shard sizes drops with every move, so the
+// loop ends. The pair counts are read once, in constant time per pair.
+std::size_t ShardedDataStructure::Rebalance() {
+  if (mRouting != Routing::InitialPair || mShards.size() < 2) {
+    return 0;
+  }
+
+  std::array<std::size_t, PAIR_COUNT> pairItemCounts;
+  for (std::size_t pairKey = 0; pairKey < PAIR_COUNT; ++pairKey) {
+    pairItemCounts[pairKey] = static_cast<std::size_t>(mShards[mPairShards[pairKey]].GetListItemsNumber(
+        static_cast<char>('A' + pairKey / LETTER_COUNT), static_cast<char>('A' + pairKey % LETTER_COUNT)));
+  }
+  std::vector<std::size_t> shardItemCounts;
+  shardItemCounts.reserve(mShards.size());
+  for (const DataStructure& shard : mShards) {
+    shardItemCounts.push_back(static_cast<std::size_t>(shard.GetItemsNumber()));
+  }
+
+  std::size_t movedCount = 0;
+  for (;;) {
+    const auto [emptiest, fullest] = std::minmax_element(shardItemCounts.begin(), shardItemCounts.end());
+    const std::size_t from = static_cast<std::size_t>(fullest - shardItemCounts.begin());
+    const std::size_t to = static_cast<std::size_t>(emptiest - shardItemCounts.begin());
+    const std::size_t gap = *fullest - *emptiest;
+
+    std::size_t bestPairKey = PAIR_COUNT;
+    std::size_t bestDistance = gap;
+    for (std::size_t pairKey = 0; pairKey < PAIR_COUNT; ++pairKey) {
+      const std::size_t pairItemCount = pairItemCounts[pairKey];
+      if (mPairShards[pairKey] != from || pairItemCount == 0 || pairItemCount >= gap) {
+        continue;
+      }
+      const std::size_t distance = pairItemCount * 2 > gap ? pairItemCount * 2 - gap : gap - pairItemCount * 2;
+      if (distance < bestDistance) {
+        bestDistance = distance;
+        bestPairKey = pairKey;
+      }
+    }
+    if (bestPairKey == PAIR_COUNT) {
+      return movedCount;
+    }
+
+    movedCount += movePair(bestPairKey, from, to);
+    shardItemCounts[from] -= pairItemCounts[bestPairKey];
+    shardItemCounts[to] += pairItemCounts[bestPairKey];
+  }
+}
+
+// The items are first copied into the target and only then removed from the
+// source, which cannot fail for items that are known to be there. Their IDs
+// are copied up front, before anything is changed, so that the removals do
+// not allocate and do not read an ID out of the item being destroyed.
+std::size_t ShardedDataStructure::movePair(std::size_t pairKey, std::size_t from, std::size_t to) {
+  DataStructure& source = mShards[from];
+  DataStructure& target = mShards[to];
+  std::vector<const Item*> pairItems;
+  source.ForEachInitialPair(static_cast<char>('A' + pairKey / LETTER_COUNT),
+                            static_cast<char>('A' + pairKey % LETTER_COUNT),
+                            [&pairItems](const Item& pairItem) { pairItems.push_back(&pairItem); });
+  std::vector<std::string> pairIdentifiers;
+  pairIdentifiers.reserve(pairItems.size());
+  for (const Item* pairItem : pairItems) {
+    pairIdentifiers.emplace_back(pairItem->GetID());
+  }
+
+  std::size_t copiedCount = 0;
+  try {
+    for (; copiedCount < pairItems.size(); ++copiedCount) {
+      target += Item(*pairItems[copiedCount]);
+    }
+  } catch (...) {
+    while (copiedCount > 0) {
+      target.Remove(pairIdentifiers[--copiedCount]);
+    }
+    throw;
+  }
+
+  mPairShards[pairKey] = static_cast<std::uint16_t>(to);
+  for (const std::string& itemIdentifier : pairIdentifiers) {
+    source.Remove(itemIdentifier);
+  }
+  return pairItems.size();
+}
+
+void ShardedDataStructure::Clear() {
+  for (DataStructure& shard : mShards) {
+    shard.Clear();
+  }
+}
@@ -0,0 +1,116 @@
+#pragma once
+
+#include "DataStructure.h"
+#include "Item.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+// =============================================================================
+// ShardedDataStructure: A front end that spreads items over N DataStructures.
+//
+// Every ID is routed to exactly one shard, either by its initial pair (the
+// 26 x 26 letter pairs of the two words, e.g. "CN" for "Cafe Noir") through
+// a routing table, or by a hash of the full ID. GetItem, operator+= and
+// operator-= touch only the shard the ID is routed to. Each shard is an
+// ordinary DataStructure, so it can be inspected, exported or snapshotted
+// on its own, e.g. to hand it to another process that serves that shard.
+//
+// The IDs of Colors.txt are far from evenly spread over the initial pairs,
+// so shards routed by pair drift apart as items are added. Rebalance()
+// reassigns whole pairs from the fullest to the emptiest shard and moves
+// their items along. Items routed by hash stay balanced statistically and
+// are never moved, but a shard then no longer holds complete letter pairs.
+//
+// Like DataStructure, the front end is not thread-safe; distinct shards may
+// be read or modified from different threads through GetShard.
+// =============================================================================
+class ShardedDataStructure
+{
+public:
+  // How IDs are assigned to shards.
+  enum class Routing {
+    // By initial pair through a routing table that Rebalance() can change.
+    // Pairs start out dealt round-robin over the shards.
+    InitialPair,
+
+    // By ItemIdIndex::Hash of the full ID modulo the shard count; fixed.
+    IdHash
+  };
+
+  // Number of initial pairs (26 x 26).
+  static constexpr std::size_t PAIR_COUNT = 26 * 26;
+
+  // Creates shardCount empty shards (1 to PAIR_COUNT) with the given settings.
+  // Throws std::runtime_error if shardCount is out of range.
+  explicit ShardedDataStructure(std::size_t shardCount, Routing routing = Routing::InitialPair,
+                                const DataStructure::Options& options = DataStructure::Options());
+
+  std::size_t GetShardCount() const { return mShards.size(); }
+  Routing GetRouting() const { return mRouting; }
+
+  // Returns a shard. Adding to it an item that is routed elsewhere breaks
+  // the lookups of the front end.
+  const DataStructure& GetShard(std::size_t shardIndex) const { return mShards[shardIndex]; }
+  DataStructure& GetShard(std::size_t shardIndex) { return mShards[shardIndex]; }
+
+  // Stores in shardIndex the shard pID is routed to and returns true, or
+  // returns false if pID is invalid.
+  bool TryGetShardIndex(std::string_view pID, std::size_t& shardIndex) const;
+
+  // Returns the total number of items over all shards.
+  int GetItemsNumber() const;
+
+  // Returns the item count of the fullest shard divided by the mean item
+  // count: 1.0 for perfectly even shards (or none), GetShardCount() if one
+  // shard holds everything.
+  double GetImbalance() const;
+
+  // Searches the shard of pID. Returns nullptr if the item is not found or
+  // the ID is invalid.
+  Item* GetItem(char* pID) const;
+  Item* GetItem(std::string_view pID) const;
+  bool Contains(std::string_view pID) const;
+
+  // Adds an item to its shard.
+  // Throws std::runtime_error if the ID is invalid or item already exists.
+  void operator+=(Item& item);
+  void operator+=(Item&& item);
+
+  // Removes an item from its shard.
+  // Throws std::runtime_error if the ID is invalid or item not found.
+  void operator-=(char* pID);
+  void Remove(std::string_view pID);
+
+  // With Routing::InitialPair, repeatedly hands one initial pair of the
+  // fullest shard to the emptiest shard, choosing the pair whose item count
+  // is closest to half the difference between the two, until no single pair
+  // can narrow that difference any more. Returns the number of items moved
+  // (0 with Routing::IdHash). Pointers to moved items become invalid.
+  // A pair is moved all at once: if copying its items throws (e.g.
+  // std::bad_alloc), the pair stays where it was and the exception is
+  // rethrown; the pairs moved before are kept.
+  std::size_t Rebalance();
+
+  // Removes all items from all shards; the routing table is kept.
+  void Clear();
+
+private:
+  // Returns the key (0 to PAIR_COUNT - 1) of the initial pair of pID, or
+  // false if pID is invalid.
+  static bool tryGetPairKey(std::string_view pID, std::size_t& pairKey);
+
+  // Returns the shard of pID, or throws std::runtime_error("Invalid ID").
+  DataStructure& getShard(std::string_view pID);
+
+  // Moves the items of one initial pair from shard `from` to shard `to`
+  // and repoints the routing table. Returns the number of items moved.
+  std::size_t movePair(std::size_t pairKey, std::size_t from, std::size_t to);
+
+  std::vector<DataStructure> mShards;
+  Routing mRouting;
+  std::array<std::uint16_t, PAIR_COUNT> mPairShards{}; // Routing::InitialPair
+};
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+// =============================================================================
+// SpscRingBuffer: A bounded lock-free queue for one producer and one consumer.
+//
+// The slots form a ring whose size is a power of two. The producer owns the
+// tail index and the consumer the head index; each publishes its index with
+// a release store and reads the other's with an acquire load, so a value is
+// fully written before the consumer can see it and the slot is vacated
+// before the producer can reuse it. Both sides keep a cached copy of the
+// other's index and only reload it when the ring looks full (or empty),
+// so the shared cache lines are touched once per lap rather than per item.
+//
+// TryPush fails while the ring is full, which is how a stage applies
+// backpressure to the stage before it. Exactly one thread may push and one
+// (other) thread may pop at any time.
+// =============================================================================
+template <typename Value>
+class SpscRingBuffer
+{
+public:
+  // Creates a ring holding at least capacity values (at least 2). Value
+  // must be default-constructible and move-assignable.
+  explicit SpscRingBuffer(std::size_t capacity) : mSlots(roundUpToPowerOfTwo(capacity)), mMask(mSlots.size() - 1) {}
+
+  SpscRingBuffer(const SpscRingBuffer&) = delete;
+  SpscRingBuffer& operator=(const SpscRingBuffer&) = delete;
+
+  std::size_t Capacity() const { return mSlots.size(); }
+
+  // Producer only: moves value into the ring and returns true, or returns
+  // false and leaves value unchanged if the ring is full.
+  bool TryPush(Value& value) {
+    const std::size_t tail = mTail.load(std::memory_order_relaxed);
+    if (tail - mCachedHead == mSlots.size()) {
+      mCachedHead = mHead.load(std::memory_order_acquire);
+      if (tail - mCachedHead == mSlots.size()) {
+        return false;
+      }
+    }
+    mSlots[tail & mMask] = std::move(value);
+    mTail.store(tail + 1, std::memory_order_release);
+    return true;
+  }
+
+  // Consumer only: moves the oldest value into value and returns true, or
+  // returns false if the ring is empty.
+  bool TryPop(Value& value) {
+    const std::size_t head = mHead.load(std::memory_order_relaxed);
+    if (head == mCachedTail) {
+      mCachedTail = mTail.load(std::memory_order_acquire);
+      if (head == mCachedTail) {
+        return false;
+      }
+    }
+    value = std::move(mSlots[head & mMask]);
+    mHead.store(head + 1, std::memory_order_release);
+    return true;
+  }
+
+private:
+  static std::size_t roundUpToPowerOfTwo(std::size_t capacity) {
+    std::size_t slotCount = 2;
+    while (slotCount < capacity) {
+      slotCount *= 2;
+    }
+    return slotCount;
+  }
+
+  std::vector<Value> mSlots;
+  const std::size_t mMask;
+
+  // The indexes only grow; a slot is index & mMask. Each side's index and
+  // its cached copy of the other side's share a cache line of their own.
+  alignas(64) std::atomic<std::size_t> mHead{0}; // Next value to pop
+  std::size_t mCachedTail = 0;                   // Consumer's copy of mTail
+  alignas(64) std::atomic<std::size_t> mTail{0}; // Next slot to push into
+  std::size_t mCachedHead = 0;                   // Producer's copy of mHead
+};
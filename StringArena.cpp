@@ -0,0 +1,83 @@
+#include "StringArena.h"
+
+#include <cstring>
+#include <utility>
+
+namespace {
+
+// Size of a regular block. Strings longer than a quarter of this
+// are given a dedicated block so they do not waste the current one.
+constexpr std::size_t BLOCK_SIZE = 16 * 1024;
+constexpr std::size_t MAX_SHARED_STRING_SIZE = BLOCK_SIZE / 4;
+
+} // namespace
+
+// Move constructor: takes over the blocks; the source is left empty.
+StringArena::StringArena(StringArena&& source) noexcept
+    : mBlocks(std::move(source.mBlocks)), mCursor(std::exchange(source.mCursor, nullptr)),
+      mRemaining(std::exchange(source.mRemaining, 0)), mCapacity(std::exchange(source.mCapacity, 0)) {
+  source.mBlocks.clear();
+}
+
+// Move assignment: frees the current blocks and takes over those of the source.
+StringArena& StringArena::operator=(StringArena&& source) noexcept {
+  if (this != &source) {
+    mBlocks = std::move(source.mBlocks);
+    source.mBlocks.clear();
+    mCursor = std::exchange(source.mCursor, nullptr);
+    mRemaining = std::exchange(source.mRemaining, 0);
+    mCapacity = std::exchange(source.mCapacity, 0);
+  }
+  return *this;
+}
+
+// Copies source into the current block, starting a new block when it is full.
+char* StringArena::Duplicate(const char* source) {
+  if (!source) {
+    return nullptr;
+  }
+
+  const std::size_t length = std::strlen(source) + 1;
+  char* copy;
+  if (length > MAX_SHARED_STRING_SIZE) {
+    copy = allocateBlock(length);
+  } else {
+    if (length > mRemaining) {
+      mCursor = allocateBlock(BLOCK_SIZE);
+      mRemaining = BLOCK_SIZE;
+    }
+    copy = mCursor;
+    mCursor += length;
+    mRemaining -= length;
+  }
+  std::memcpy(copy, source, length);
+  return copy;
+}
+
+// Only the block list can fail to grow, and it is reserved before anything moves.
+void StringArena::Absorb(StringArena&& source) {
+  if (this == &source) {
+    return;
+  }
+  mBlocks.reserve(mBlocks.size() + source.mBlocks.size());
+  for (auto& sourceBlock : source.mBlocks) {
+    mBlocks.push_back(std::move(sourceBlock));
+  }
+  mCapacity += source.mCapacity;
+  source.Release();
+}
+
+// Frees all blocks at once.
+void StringArena::Release() {
+  mBlocks.clear();
+  mCursor = nullptr;
+  mRemaining = 0;
+  mCapacity = 0;
+}
+
+// Allocates a block and keeps ownership of it until Release().
+char* StringArena::allocateBlock(std::size_t blockSize) {
+  mBlocks.push_back(std::unique_ptr<char[]>(new char[blockSize]));
+  mCapacity += blockSize;
+  return mBlocks.back().get();
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+// =============================================================================
+// StringArena: A bump allocator for C-strings.
+//
+// Strings are copied into large blocks one after another, so storing an item
+// costs no separate heap allocation per string, and strings added together
+// end up next to each other in memory. Individual strings are never freed;
+// all blocks are released at once by Release() or by the destructor.
+//
+// Strings that are too large to share a block get a block of their own.
+// =============================================================================
+class StringArena
+{
+public:
+  StringArena() = default;
+  ~StringArena() = default;
+
+  // An arena owns the memory that stored items point into,
+  // so it can be moved but not copied.
+  StringArena(const StringArena&) = delete;
+  StringArena& operator=(const StringArena&) = delete;
+  StringArena(StringArena&& source) noexcept;
+  StringArena& operator=(StringArena&& source) noexcept;
+
+  // Copies a C-string into the arena and returns the copy.
+  // Returns nullptr if source is nullptr.
+  char* Duplicate(const char* source);
+
+  // Takes over the blocks of source, so that the strings it handed out stay
+  // valid as long as this arena; source is left empty. New strings keep
+  // going into the current block of this arena. If memory runs out, both
+  // arenas are left unchanged.
+  void Absorb(StringArena&& source);
+
+  // Frees all blocks. Every string handed out before becomes invalid.
+  void Release();
+
+  // Returns the total number of bytes allocated for blocks.
+  std::size_t GetCapacity() const { return mCapacity; }
+
+private:
+  // Allocates a new block of the given size and records it.
+  char* allocateBlock(std::size_t blockSize);
+
+  std::vector<std::unique_ptr<char[]>> mBlocks;
+  char* mCursor = nullptr;     // Next free byte in the current block
+  std::size_t mRemaining = 0;  // Free bytes left in the current block
+  std::size_t mCapacity = 0;
+};
@@ -0,0 +1,152 @@
+#include "SyntheticItemSource.h"
+
+#include "ItemIdentifier.h"
+#include "ItemTime.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <stdexcept>
+#include <thread>
+
+namespace {
+
+constexpr char UTF8_BYTE_ORDER_MARK[] = "\xEF\xBB\xBF";
+
+// Longest "-<letters>" suffix needed to number 2^64 rounds of names.
+constexpr std::size_t MAX_SUFFIX_SIZE = 16;
+
+// Mixes a 64-bit value into a well-distributed one (SplitMix64 finalizer).
+unsigned long long mixBits(unsigned long long value) {
+  value += 0x9E3779B97F4A7C15ULL;
+  value = (value ^ (value >> 30)) * 0xBF58476D1CE4E5B9ULL;
+  value = (value ^ (value >> 27)) * 0x94D049BB133111EBULL;
+  return value ^ (value >> 31);
+}
+
+// FNV-1a hash of a C-string, used to derive the values of a requested ID.
+unsigned long long hashText(const char* text) {
+  unsigned long long hash = 0xCBF29CE484222325ULL;
+  for (; *text; ++text) {
+    hash = (hash ^ static_cast<unsigned char>(*text)) * 0x100000001B3ULL;
+  }
+  return hash;
+}
+
+// True if the name consists of exactly two words that both start with A-Z.
+bool isTwoWordName(std::string_view name) {
+  const std::size_t spacePosition = name.find(' ');
+  if (spacePosition == std::string_view::npos || spacePosition + 1 == name.size() ||
+      name.find(' ', spacePosition + 1) != std::string_view::npos) {
+    return false;
+  }
+  std::size_t letterIndex;
+  return item_identifier::tryGetLetterIndex(name[0], letterIndex) &&
+         item_identifier::tryGetLetterIndex(name[spacePosition + 1], letterIndex);
+}
+
+// Allocates an item: the record with new, the strings with new[].
+// The ID is name followed by suffix; Code and pTime are derived from valueSeed.
+ITEM1* createItem(std::string_view name, std::string_view suffix, unsigned long long valueSeed) {
+  const unsigned long long codeBits = mixBits(valueSeed);
+  const auto secondOfDay = static_cast<std::uint32_t>(mixBits(codeBits) % item_time::SECONDS_PER_DAY);
+
+  ITEM1* item = new ITEM1{nullptr, static_cast<unsigned long>(codeBits), nullptr, nullptr};
+  try {
+    item->pID = new char[name.size() + suffix.size() + 1];
+    std::memcpy(item->pID, name.data(), name.size());
+    if (!suffix.empty()) {
+      std::memcpy(item->pID + name.size(), suffix.data(), suffix.size());
+    }
+    item->pID[name.size() + suffix.size()] = '\0';
+
+    char timeText[item_time::TIME_TEXT_SIZE];
+    item_time::formatTime(secondOfDay, timeText);
+    item->pTime = new char[item_time::TIME_TEXT_SIZE];
+    std::memcpy(item->pTime, timeText, item_time::TIME_TEXT_SIZE);
+  } catch (...) {
+    delete[] item->pID;
+    delete item;
+    throw;
+  }
+  return item;
+}
+
+} // namespace
+
+SyntheticItemSource::SyntheticItemSource() : SyntheticItemSource(Options()) {}
+
+// Maps the colours file and collects its names.
+SyntheticItemSource::SyntheticItemSource(const Options& options)
+    : mOptions(options), mColorsFile(mOptions.colorsPath) {
+  collectNames();
+}
+
+// Keeps every distinct two-word line; trailing spaces and CRs are ignored.
+void SyntheticItemSource::collectNames() {
+  std::string_view fileText(mColorsFile.GetData(), mColorsFile.GetSize());
+  if (fileText.compare(0, sizeof(UTF8_BYTE_ORDER_MARK) - 1, UTF8_BYTE_ORDER_MARK) == 0) {
+    fileText.remove_prefix(sizeof(UTF8_BYTE_ORDER_MARK) - 1);
+  }
+
+  while (!fileText.empty()) {
+    const std::size_t lineEnd = std::min(fileText.find('\n'), fileText.size());
+    std::string_view line = fileText.substr(0, lineEnd);
+    fileText.remove_prefix(std::min(lineEnd + 1, fileText.size()));
+
+    while (!line.empty() && (line.back() == '\r' || line.back() == ' ')) {
+      line.remove_suffix(1);
+    }
+    if (isTwoWordName(line)) {
+      mNames.push_back(line);
+    }
+  }
+
+  std::sort(mNames.begin(), mNames.end());
+  mNames.erase(std::unique(mNames.begin(), mNames.end()), mNames.end());
+  if (mNames.empty()) {
+    throw std::runtime_error("No two-word colour names in " + mOptions.colorsPath);
+  }
+}
+
+// A requested ID keeps its text and gets values derived from it;
+// a random item takes the next position in the seeded sequence.
+ITEM1* SyntheticItemSource::FetchItem(char* pID) {
+  if (mOptions.fetchLatencyMicroseconds > 0) {
+    std::this_thread::sleep_for(std::chrono::microseconds(mOptions.fetchLatencyMicroseconds));
+  }
+  if (pID) {
+    item_identifier::ParsedItemIdentifier parsedIdentifier;
+    if (!item_identifier::tryParseItemIdentifier(pID, parsedIdentifier)) {
+      throw std::runtime_error("Invalid ID");
+    }
+    return createItem(pID, std::string_view(), mixBits(mOptions.seed) ^ hashText(pID));
+  }
+
+  const unsigned long long itemNumber = mNextRandomItem.fetch_add(1, std::memory_order_relaxed);
+  const unsigned long long valueSeed = mixBits(mOptions.seed + itemNumber);
+  if (!mOptions.uniqueIdentifiers) {
+    return createItem(mNames[valueSeed % mNames.size()], std::string_view(), valueSeed);
+  }
+
+  // Round r of the names gets the suffix "-" + r written in base-26 letters.
+  char suffix[MAX_SUFFIX_SIZE];
+  std::size_t suffixLength = 0;
+  unsigned long long round = itemNumber / mNames.size();
+  if (round > 0) {
+    suffix[suffixLength++] = '-';
+    for (; round > 0; round /= 26) {
+      suffix[suffixLength++] = static_cast<char>('a' + round % 26);
+    }
+  }
+  return createItem(mNames[itemNumber % mNames.size()], std::string_view(suffix, suffixLength), valueSeed);
+}
+
+void SyntheticItemSource::Release(ITEM1* item) {
+  if (!item) {
+    return;
+  }
+  delete[] item->pID;
+  delete[] item->pTime;
+  delete item;
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+#include "ItemSource.h"
+#include "MappedFile.h"
+
+#include <atomic>
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// =============================================================================
+// SyntheticItemSource: An in-process item generator for load tests.
+//
+// Maps Colors.txt into memory once and builds items from its two-word names
+// without calling the data provider, so the container itself can be stressed
+// at millions of items per second and without the Windows import libraries.
+//
+// Generated items have a pseudo-random Code and an "hh:mm:ss" pTime:
+// - FetchItem(pID) derives them from pID, so the same ID always gets the same
+//   values (as a cache of provider results expects)
+// - FetchItem(nullptr) picks a random name; with uniqueIdentifiers set, the
+//   names are instead used in turn and suffixed with "-a", "-b", ... once all
+//   of them have been handed out, so millions of random items stay distinct
+//
+// Any well-formed ID is accepted, not only those listed in Colors.txt.
+// The sequence depends only on the seed and the call order; FetchItem is
+// thread-safe without taking a lock.
+// =============================================================================
+class SyntheticItemSource : public ItemSource
+{
+public:
+  struct Options {
+    // File with one colour name per line.
+    std::string colorsPath = "Colors.txt";
+
+    // Seeds Code, pTime and the choice of random names.
+    unsigned long long seed = 1;
+
+    // Make items fetched without an ID distinct from each other.
+    bool uniqueIdentifiers = false;
+
+    // Time every FetchItem call waits before returning, to simulate the
+    // latency of a slow provider; 0 answers immediately.
+    unsigned fetchLatencyMicroseconds = 0;
+  };
+
+  // Reads the colour names; throws std::runtime_error if the file cannot be
+  // mapped or holds no two-word name.
+  SyntheticItemSource();
+  explicit SyntheticItemSource(const Options& options);
+
+  SyntheticItemSource(const SyntheticItemSource&) = delete;
+  SyntheticItemSource& operator=(const SyntheticItemSource&) = delete;
+
+  // Generates the item with the given identifier, or the next random item if
+  // pID is nullptr. Throws std::runtime_error if pID is not a valid ID.
+  ITEM1* FetchItem(char* pID) override;
+
+  // Frees an item generated by FetchItem together with its strings.
+  void Release(ITEM1* item) override;
+
+  // Returns the number of usable colour names read from the file.
+  std::size_t GetNameCount() const { return mNames.size(); }
+
+private:
+  // Splits the mapped file into lines and keeps the distinct two-word names.
+  void collectNames();
+
+  Options mOptions;
+  MappedFile mColorsFile;
+  std::vector<std::string_view> mNames;  // Point into the mapped file
+  std::atomic<unsigned long long> mNextRandomItem{0};
+};
@@ -0,0 +1,179 @@
+#pragma once
+
+#include "ItemIdentifier.h"
+#include "TypedItem.h"
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstring>
+#include <forward_list>
+#include <memory>
+#include <ostream>
+#include <stdexcept>
+#include <utility>
+
+// =============================================================================
+// TypedDataStructure: The two-level DataStructure layout for any ITEMn.
+//
+// Stores TypedItem<ITEMn> in 26 lazily allocated buckets (by the initial of
+// the first word), each holding 26 lists (by the initial of the second
+// word), with the same rules and exceptions as DataStructure. The item type
+// is a template parameter, so the structure is fully inlined for each of
+// ITEM1..ITEM10 and never dispatches on the type at run time.
+//
+// Example: TypedDataStructure<ITEM5> holds items whose date is a DATE1*.
+// =============================================================================
+template <typename TItem>
+class TypedDataStructure
+{
+public:
+  using ItemType = TypedItem<TItem>;
+
+  TypedDataStructure() = default;
+  ~TypedDataStructure() = default;
+
+  // Copy constructor: copies every list in its original order.
+  TypedDataStructure(const TypedDataStructure& original) : mItemCount(original.mItemCount) {
+    for (std::size_t bucketIndex = 0; bucketIndex < item_identifier::LETTER_COUNT; ++bucketIndex) {
+      if (original.mBuckets[bucketIndex]) {
+        mBuckets[bucketIndex] = std::make_unique<Bucket>(*original.mBuckets[bucketIndex]);
+      }
+    }
+  }
+
+  // Builds the copy first so that a failure leaves *this untouched.
+  TypedDataStructure& operator=(const TypedDataStructure& right) {
+    if (this != &right) {
+      TypedDataStructure copy(right);
+      *this = std::move(copy);
+    }
+    return *this;
+  }
+
+  // Move constructor and assignment: take over the buckets of the source,
+  // which is left empty.
+  TypedDataStructure(TypedDataStructure&& source) noexcept
+      : mBuckets(std::move(source.mBuckets)), mItemCount(std::exchange(source.mItemCount, 0)) {}
+
+  TypedDataStructure& operator=(TypedDataStructure&& source) noexcept {
+    if (this != &source) {
+      mBuckets = std::move(source.mBuckets);
+      mItemCount = std::exchange(source.mItemCount, 0);
+    }
+    return *this;
+  }
+
+  // Removes all items and releases the buckets.
+  void Clear() {
+    for (auto& bucket : mBuckets) {
+      bucket.reset();
+    }
+    mItemCount = 0;
+  }
+
+  // Returns the total number of items. Runs in constant time.
+  int GetItemsNumber() const { return mItemCount; }
+
+  // Searches for an item by its ID string (e.g., "Cafe Noir").
+  // Returns a pointer to the item if found, or nullptr if not found.
+  ItemType* GetItem(char* pID) const {
+    ItemList* itemList = findList(pID);
+    if (!itemList) {
+      return nullptr;
+    }
+    const auto foundItem = std::find_if(itemList->begin(), itemList->end(), [pID](const ItemType& candidateItem) {
+      return std::strcmp(candidateItem.GetID(), pID) == 0;
+    });
+    return foundItem == itemList->end() ? nullptr : &(*foundItem);
+  }
+
+  // Adds a copy of an item.
+  // Throws std::runtime_error if the ID is invalid or item already exists.
+  void operator+=(const ItemType& item) {
+    prepareInsert(item.GetID()).push_front(item);
+    ++mItemCount;
+  }
+
+  // Adds an item, taking over its allocations.
+  // Throws std::runtime_error if the ID is invalid or item already exists,
+  // in which case the item is left unchanged.
+  void operator+=(ItemType&& item) {
+    prepareInsert(item.GetID()).push_front(std::move(item));
+    ++mItemCount;
+  }
+
+  // Removes an item by its ID string.
+  // Throws std::runtime_error if the ID is invalid or item not found.
+  void operator-=(char* pID) {
+    item_identifier::ParsedItemIdentifier parsedIdentifier;
+    if (!item_identifier::tryParseItemIdentifier(pID, parsedIdentifier)) {
+      throw std::runtime_error("Invalid ID");
+    }
+    ItemList* itemList = findList(pID);
+    if (itemList) {
+      for (auto previousIterator = itemList->before_begin(), currentIterator = itemList->begin();
+           currentIterator != itemList->end(); previousIterator = currentIterator++) {
+        if (std::strcmp(currentIterator->GetID(), pID) == 0) {
+          itemList->erase_after(previousIterator);
+          --mItemCount;
+          return;
+        }
+      }
+    }
+    throw std::runtime_error("Item not found");
+  }
+
+  // Prints all items, one per line.
+  friend std::ostream& operator<<(std::ostream& outputStream, const TypedDataStructure& dataStructure) {
+    for (const auto& bucket : dataStructure.mBuckets) {
+      if (!bucket) {
+        continue;
+      }
+      for (const auto& itemList : bucket->lists) {
+        for (const ItemType& currentItem : itemList) {
+          outputStream << currentItem << '\n';
+        }
+      }
+    }
+    return outputStream;
+  }
+
+private:
+  using ItemList = std::forward_list<ItemType>;
+
+  struct Bucket {
+    std::array<ItemList, item_identifier::LETTER_COUNT> lists;
+  };
+
+  // Returns the list an ID belongs to, or nullptr if the ID is invalid or
+  // its bucket has not been allocated.
+  ItemList* findList(const char* pID) const {
+    item_identifier::ParsedItemIdentifier parsedIdentifier;
+    if (!item_identifier::tryParseItemIdentifier(pID, parsedIdentifier)) {
+      return nullptr;
+    }
+    const auto& bucket = mBuckets[parsedIdentifier.firstWordIndex];
+    return bucket ? &bucket->lists[parsedIdentifier.secondWordIndex] : nullptr;
+  }
+
+  // Validates a new item's ID, checks that it is not stored yet and
+  // returns the list to add it to (allocating its bucket if needed).
+  ItemList& prepareInsert(char* pID) {
+    item_identifier::ParsedItemIdentifier parsedIdentifier;
+    if (!item_identifier::tryParseItemIdentifier(pID, parsedIdentifier)) {
+      throw std::runtime_error("Invalid ID");
+    }
+    if (GetItem(pID)) {
+      throw std::runtime_error("Item already exists");
+    }
+    auto& bucket = mBuckets[parsedIdentifier.firstWordIndex];
+    if (!bucket) {
+      bucket = std::make_unique<Bucket>();
+    }
+    return bucket->lists[parsedIdentifier.secondWordIndex];
+  }
+
+  std::array<std::unique_ptr<Bucket>, item_identifier::LETTER_COUNT> mBuckets;
+  int mItemCount = 0;
+};
@@ -0,0 +1,106 @@
+#pragma once
+
+#include "ItemTraits.h"
+
+#include <cstring>
+#include <ostream>
+#include <stdexcept>
+#include <utility>
+
+// =============================================================================
+// TypedItem: The Item class generalised to any of ITEM1..ITEM10.
+//
+// TypedItem<ITEMn> inherits from ITEMn and owns its ID and its time or date
+// member, with the same construction, copy and move semantics as Item. How
+// the time or date is copied and released comes from ItemTraits<ITEMn>, so
+// every operation is resolved at compile time.
+//
+// Item remains the ITEM1 class used by DataStructure, with the provider
+// cache, item sources and string arena support on top of this behaviour.
+// =============================================================================
+template <typename TItem>
+class TypedItem : public TItem
+{
+public:
+  using Traits = ItemTraits<TItem>;
+
+  // Fetches the item with the given identifier from the data provider,
+  // or a random item if pID is nullptr, and makes a deep copy of it. The
+  // provider's item is left as it is (see ItemTraitsBase::Fetch).
+  explicit TypedItem(char* pID = nullptr) : TItem() {
+    const TItem* fetchedItem = Traits::Fetch(pID);
+    if (!fetchedItem || !fetchedItem->pID) {
+      throw std::runtime_error("Failed to retrieve item from provider");
+    }
+    copyFrom(*fetchedItem);
+  }
+
+  // Creates a deep copy of a plain ITEMn record.
+  explicit TypedItem(const TItem& orig) : TItem() { copyFrom(orig); }
+
+  TypedItem(const TypedItem& orig) : TItem() { copyFrom(orig); }
+
+  // Takes over the allocations of orig, which is left without an ID.
+  TypedItem(TypedItem&& orig) noexcept : TItem() { takeFrom(orig); }
+
+  ~TypedItem() { release(); }
+
+  // Builds the copy first so that a failure leaves *this unchanged.
+  TypedItem& operator=(const TypedItem& right) {
+    if (this != &right) {
+      TypedItem copy(right);
+      *this = std::move(copy);
+    }
+    return *this;
+  }
+
+  TypedItem& operator=(TypedItem&& right) noexcept {
+    if (this != &right) {
+      release();
+      takeFrom(right);
+    }
+    return *this;
+  }
+
+  // Two items are equal if they have the same ID string.
+  bool operator==(const TypedItem& other) const {
+    if (!this->pID || !other.pID) {
+      return this->pID == other.pID;
+    }
+    return std::strcmp(this->pID, other.pID) == 0;
+  }
+
+  // Prints the item's ID, or "(null)" if the ID is empty.
+  friend std::ostream& operator<<(std::ostream& outputStream, const TypedItem& itemToOutput) {
+    return outputStream << (itemToOutput.pID ? itemToOutput.pID : "(null)");
+  }
+
+  char* GetID() const { return this->pID; }
+
+private:
+  void copyFrom(const TItem& source) {
+    this->pID = item_traits_detail::duplicateString(source.pID);
+    this->Code = source.Code;
+    try {
+      Traits::CopyPayload(*this, source);
+    } catch (...) {
+      delete[] this->pID;
+      this->pID = nullptr;
+      throw;
+    }
+    this->pNext = nullptr;
+  }
+
+  void takeFrom(TypedItem& source) {
+    this->pID = std::exchange(source.pID, nullptr);
+    this->Code = source.Code;
+    Traits::TransferPayload(*this, source);
+    this->pNext = nullptr;
+  }
+
+  void release() {
+    delete[] this->pID;
+    this->pID = nullptr;
+    Traits::ReleasePayload(*this);
+  }
+};
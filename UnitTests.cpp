@@ -0,0 +1,733 @@
+#include "ConcurrentDataStructure.h"
+#include "DataStructure.h"
+#include "DataStructureSnapshot.h"
+#include "EpochReclamation.h"
+#include "IngestionPipeline.h"
+#include "Item.h"
+#include "ItemSource.h"
+#include "ReadOptimizedDataStructure.h"
+#include "SyntheticItemSource.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// =============================================================================
+// Unit tests of the DataStructure extensions.
+//
+// Each test prints "Test N (name): passed" or "failed" like EvaluationTest
+// does, and the exit code is the number of failed tests. Items are generated
+// by a SyntheticItemSource, so Colors.txt must be in the working directory
+// but the data provider DLL is never called. The snapshot tests write and
+// delete temporary files in the working directory.
+//
+// The concurrent tests only prove something under a race detector: run them
+// in a build with ThreadSanitizer and in one with AddressSanitizer as well
+// (e.g. g++ -fsanitize=thread, g++ -fsanitize=address, or cl /fsanitize=address).
+//
+// Usage: unittests
+// =============================================================================
+
+namespace {
+
+// Number of calls of the global operator new that still succeed before one
+// throws std::bad_alloc; negative while no failure is armed. Only a single
+// allocation fails, so the cleanup after it can still allocate.
+std::atomic<long> allocationsBeforeFailure{-1};
+
+} // namespace
+
+// The other forms are replaced as well, so that they all allocate from the
+// same heap even where a sanitizer replaces the defaults.
+void* operator new(std::size_t size) {
+  if (allocationsBeforeFailure.load(std::memory_order_relaxed) >= 0 &&
+      allocationsBeforeFailure.fetch_sub(1, std::memory_order_relaxed) == 0) {
+    throw std::bad_alloc();
+  }
+  void* memory = std::malloc(size != 0 ? size : 1);
+  if (!memory) {
+    throw std::bad_alloc();
+  }
+  return memory;
+}
+
+void* operator new[](std::size_t size) {
+  return ::operator new(size);
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+  try {
+    return ::operator new(size);
+  } catch (const std::bad_alloc&) {
+    return nullptr;
+  }
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept {
+  return ::operator new(size, std::nothrow);
+}
+
+void operator delete(void* memory) noexcept {
+  std::free(memory);
+}
+
+void operator delete[](void* memory) noexcept {
+  ::operator delete(memory);
+}
+
+void operator delete(void* memory, std::size_t) noexcept {
+  ::operator delete(memory);
+}
+
+void operator delete[](void* memory, std::size_t) noexcept {
+  ::operator delete(memory);
+}
+
+void operator delete(void* memory, const std::nothrow_t&) noexcept {
+  ::operator delete(memory);
+}
+
+void operator delete[](void* memory, const std::nothrow_t&) noexcept {
+  ::operator delete(memory);
+}
+
+namespace {
+
+// Throws std::runtime_error(failure) unless condition holds.
+void check(bool condition, const char* failure) {
+  if (!condition) {
+    throw std::runtime_error(failure);
+  }
+}
+
+// Returns itemCount distinct items generated by a SyntheticItemSource.
+std::vector<Item> generateItems(std::size_t itemCount) {
+  SyntheticItemSource::Options sourceOptions;
+  sourceOptions.uniqueIdentifiers = true;
+  SyntheticItemSource source(sourceOptions);
+
+  std::vector<Item> items;
+  items.reserve(itemCount);
+  while (items.size() < itemCount) {
+    ITEM1* generatedItem = source.FetchItem(nullptr);
+    try {
+      items.emplace_back(*generatedItem);
+    } catch (...) {
+      source.Release(generatedItem);
+      throw;
+    }
+    source.Release(generatedItem);
+  }
+  return items;
+}
+
+// -----------------------------------------------------------------------------
+// ReadOptimizedDataStructure and EpochReclamation
+// -----------------------------------------------------------------------------
+
+// A retired node that counts its deletion.
+struct CountedNode {
+  explicit CountedNode(std::atomic<int>& deletionCount) : mDeletionCount(deletionCount) {}
+  ~CountedNode() { mDeletionCount.fetch_add(1, std::memory_order_relaxed); }
+
+  std::atomic<int>& mDeletionCount;
+};
+
+// A node retired while a reader is inside an EpochGuard survives every
+// Reclaim until that reader has left it.
+void testRetiredNodesWaitForReaders() {
+  std::atomic<int> deletionCount{0};
+  std::atomic<bool> isReaderInside{false};
+  std::atomic<bool> isReaderReleased{false};
+  RetiredList retiredNodes;
+
+  std::thread reader([&]() {
+    EpochGuard epochGuard;
+    isReaderInside.store(true, std::memory_order_release);
+    while (!isReaderReleased.load(std::memory_order_acquire)) {
+      std::this_thread::yield();
+    }
+  });
+  while (!isReaderInside.load(std::memory_order_acquire)) {
+    std::this_thread::yield();
+  }
+
+  retiredNodes.Retire(new CountedNode(deletionCount));
+  for (int attempt = 0; attempt < 10; ++attempt) {
+    retiredNodes.Reclaim();
+  }
+  const bool isKeptForReader = deletionCount.load(std::memory_order_relaxed) == 0;
+  isReaderReleased.store(true, std::memory_order_release);
+  reader.join();
+  check(isKeptForReader, "a node was freed while a reader could still reach it");
+
+  retiredNodes.Reclaim();
+  check(deletionCount.load(std::memory_order_relaxed) == 1, "a node was not freed after its last reader left");
+}
+
+// Readers look up every item while writers keep adding and removing half of
+// them. The other half is never removed and must be found on every pass, and
+// an item that is found must be intact; a reclaimed node that is still read
+// shows up as a use-after-free under AddressSanitizer. Afterwards, exactly
+// the items the writers left in must be stored.
+void testReadOptimizedConcurrentReadersAndWriters() {
+  constexpr std::size_t STABLE_ITEM_COUNT = 1000;
+  constexpr std::size_t WRITER_COUNT = 2;
+  constexpr std::size_t ITEMS_PER_WRITER = 500;
+  constexpr std::size_t READER_COUNT = 3;
+  constexpr int WRITER_ROUNDS = 20;
+  constexpr int READER_PASSES = 20;
+
+  const std::vector<Item> items = generateItems(STABLE_ITEM_COUNT + WRITER_COUNT * ITEMS_PER_WRITER);
+  ReadOptimizedDataStructure dataStructure;
+  for (std::size_t itemIndex = 0; itemIndex < STABLE_ITEM_COUNT; ++itemIndex) {
+    dataStructure += items[itemIndex];
+  }
+
+  std::atomic<bool> isLost{false};
+  std::atomic<bool> isCorrupt{false};
+  std::atomic<bool> isWriterFailed{false};
+  std::vector<std::thread> threads;
+  for (std::size_t readerIndex = 0; readerIndex < READER_COUNT; ++readerIndex) {
+    threads.emplace_back([&]() {
+      for (int pass = 0; pass < READER_PASSES; ++pass) {
+        for (std::size_t itemIndex = 0; itemIndex < items.size(); ++itemIndex) {
+          const Item& expectedItem = items[itemIndex];
+          const bool isFound = dataStructure.ReadItem(expectedItem.GetID(), [&](const Item& storedItem) {
+            if (std::strcmp(storedItem.GetID(), expectedItem.GetID()) != 0 || storedItem.Code != expectedItem.Code ||
+                std::strcmp(storedItem.pTime, expectedItem.pTime) != 0) {
+              isCorrupt.store(true, std::memory_order_relaxed);
+            }
+          });
+          if (!isFound && itemIndex < STABLE_ITEM_COUNT) {
+            isLost.store(true, std::memory_order_relaxed);
+          }
+        }
+      }
+    });
+  }
+  // Each writer owns a range of items; in the last round it leaves the
+  // even-numbered ones of its range in.
+  for (std::size_t writerIndex = 0; writerIndex < WRITER_COUNT; ++writerIndex) {
+    threads.emplace_back([&, writerIndex]() {
+      const std::size_t firstItem = STABLE_ITEM_COUNT + writerIndex * ITEMS_PER_WRITER;
+      try {
+        for (int round = 0; round < WRITER_ROUNDS; ++round) {
+          for (std::size_t itemIndex = firstItem; itemIndex < firstItem + ITEMS_PER_WRITER; ++itemIndex) {
+            dataStructure += items[itemIndex];
+          }
+          for (std::size_t itemIndex = firstItem; itemIndex < firstItem + ITEMS_PER_WRITER; ++itemIndex) {
+            if (round < WRITER_ROUNDS - 1 || (itemIndex - firstItem) % 2 == 1) {
+              dataStructure -= items[itemIndex].GetID();
+            }
+          }
+        }
+      } catch (const std::exception&) {
+        isWriterFailed.store(true, std::memory_order_relaxed);
+      }
+    });
+  }
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+
+  check(!isWriterFailed.load(), "a writer failed to add or remove one of its own items");
+  check(!isLost.load(), "a reader missed an item that was never removed");
+  check(!isCorrupt.load(), "a reader saw an item with the wrong contents");
+  check(dataStructure.GetItemsNumber() ==
+            static_cast<int>(STABLE_ITEM_COUNT + WRITER_COUNT * ITEMS_PER_WRITER / 2),
+        "the item count does not match the items left in");
+  for (std::size_t itemIndex = 0; itemIndex < items.size(); ++itemIndex) {
+    const bool isExpected = itemIndex < STABLE_ITEM_COUNT || (itemIndex - STABLE_ITEM_COUNT) % 2 == 0;
+    check(dataStructure.ReadItem(items[itemIndex].GetID(), [](const Item&) {}) == isExpected,
+          "the stored items do not match the items left in");
+  }
+}
+
+// -----------------------------------------------------------------------------
+// Snapshots
+// -----------------------------------------------------------------------------
+
+// A file in the working directory that is deleted when the object goes away.
+struct TemporaryFile {
+  explicit TemporaryFile(std::string filePath) : path(std::move(filePath)) {}
+  ~TemporaryFile() { std::remove(path.c_str()); }
+
+  TemporaryFile(const TemporaryFile&) = delete;
+  TemporaryFile& operator=(const TemporaryFile&) = delete;
+
+  std::string path;
+};
+
+std::string readFile(const std::string& path) {
+  std::ifstream file(path, std::ios::binary);
+  return std::string(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+}
+
+void writeFile(const std::string& path, const std::string& contents) {
+  std::ofstream file(path, std::ios::binary | std::ios::trunc);
+  file.write(contents.data(), static_cast<std::streamsize>(contents.size()));
+  check(static_cast<bool>(file), "cannot write a test file");
+}
+
+DataStructure::Options layoutOptions(DataStructure::BucketLayout bucketLayout) {
+  DataStructure::Options options;
+  options.bucketLayout = bucketLayout;
+  return options;
+}
+
+// Checks that dataStructure holds exactly the given items.
+void checkHoldsItems(const DataStructure& dataStructure, const std::vector<Item>& items) {
+  check(dataStructure.GetItemsNumber() == static_cast<int>(items.size()), "the item count differs");
+  for (const Item& expectedItem : items) {
+    const Item* storedItem = dataStructure.GetItem(std::string_view(expectedItem.GetID()));
+    check(storedItem && storedItem->Code == expectedItem.Code && std::strcmp(storedItem->pTime, expectedItem.pTime) == 0,
+          "an item is missing or differs");
+  }
+}
+
+// SaveSnapshot followed by LoadSnapshot, and lookups in the mapped snapshot,
+// give back every item for both bucket layouts, whichever layout loads it.
+void testSnapshotRoundTrip() {
+  const std::vector<Item> items = generateItems(3000);
+  const DataStructure::BucketLayout bucketLayouts[] = {DataStructure::BucketLayout::LinkedLists,
+                                                        DataStructure::BucketLayout::HashedArrays};
+  for (const DataStructure::BucketLayout savedLayout : bucketLayouts) {
+    DataStructure saved(layoutOptions(savedLayout));
+    for (const Item& item : items) {
+      saved += Item(item);
+    }
+    const TemporaryFile snapshotFile("unittests.snapshot");
+    saved.SaveSnapshot(snapshotFile.path);
+
+    for (const DataStructure::BucketLayout loadedLayout : bucketLayouts) {
+      DataStructure loaded(layoutOptions(loadedLayout));
+      loaded.LoadSnapshot(snapshotFile.path);
+      checkHoldsItems(loaded, items);
+    }
+
+    const DataStructureSnapshot snapshot(snapshotFile.path);
+    check(snapshot.GetItemsNumber() == static_cast<int>(items.size()), "the snapshot item count differs");
+    for (const Item& expectedItem : items) {
+      DataStructureSnapshot::ItemView itemView;
+      check(snapshot.GetItem(expectedItem.GetID(), itemView) && itemView.Code == expectedItem.Code &&
+                std::strcmp(itemView.pTime, expectedItem.pTime) == 0 && std::strcmp(itemView.pID, expectedItem.GetID()) == 0,
+            "a snapshot lookup is missing or differs");
+    }
+    DataStructureSnapshot::ItemView itemView;
+    check(!snapshot.GetItem("Zzzz Zzzz", itemView) && !snapshot.GetItem("no id", itemView),
+          "a snapshot lookup found an item that was not saved");
+  }
+}
+
+// Writes an altered copy of a valid snapshot and checks that both the
+// mapped snapshot and LoadSnapshot reject it, the latter leaving the
+// structure unchanged.
+template <typename TCorruption>
+void checkRejectsCorruption(const std::string& validImage, const std::vector<Item>& items, TCorruption&& corrupt,
+                            const char* failure) {
+  std::string image = validImage;
+  corrupt(image);
+  const TemporaryFile corruptFile("unittests-corrupt.snapshot");
+  writeFile(corruptFile.path, image);
+
+  bool isRejected = false;
+  try {
+    const DataStructureSnapshot snapshot(corruptFile.path);
+  } catch (const std::runtime_error&) {
+    isRejected = true;
+  }
+  check(isRejected, failure);
+
+  DataStructure dataStructure;
+  for (const Item& item : items) {
+    dataStructure += Item(item);
+  }
+  isRejected = false;
+  try {
+    dataStructure.LoadSnapshot(corruptFile.path);
+  } catch (const std::runtime_error&) {
+    isRejected = true;
+  }
+  check(isRejected, failure);
+  checkHoldsItems(dataStructure, items);
+}
+
+// Truncated files, out-of-range offsets, unsorted lists and records in the
+// wrong list are rejected when the snapshot is opened.
+void testSnapshotRejectsCorruptFiles() {
+  using snapshot_format::SnapshotHeader;
+  using snapshot_format::SnapshotRecord;
+
+  const std::vector<Item> items = generateItems(500);
+  std::string validImage;
+  {
+    DataStructure saved;
+    for (const Item& item : items) {
+      saved += Item(item);
+    }
+    const TemporaryFile snapshotFile("unittests.snapshot");
+    saved.SaveSnapshot(snapshotFile.path);
+    validImage = readFile(snapshotFile.path);
+  }
+  check(validImage.size() > sizeof(SnapshotHeader), "the snapshot was not written");
+  const auto headerOf = [](std::string& image) { return reinterpret_cast<SnapshotHeader*>(&image[0]); };
+  const auto recordsOf = [](std::string& image) {
+    return reinterpret_cast<SnapshotRecord*>(&image[0] + sizeof(SnapshotHeader));
+  };
+
+  checkRejectsCorruption(validImage, items, [](std::string& image) { image.resize(sizeof(SnapshotHeader) / 2); },
+                         "a file shorter than the header was accepted");
+  checkRejectsCorruption(validImage, items, [](std::string& image) { image.pop_back(); },
+                         "a file with a truncated string table was accepted");
+  checkRejectsCorruption(validImage, items,
+                         [&](std::string& image) { recordsOf(image)[0].idOffset = headerOf(image)->stringTableSize; },
+                         "a record pointing past the string table was accepted");
+  checkRejectsCorruption(validImage, items,
+                         [&](std::string& image) { headerOf(image)->stringTableOffset = image.size() + 1; },
+                         "a string table past the end of the file was accepted");
+
+  // Swaps the first two records of the first list that has two.
+  checkRejectsCorruption(validImage, items,
+                         [&](std::string& image) {
+                           const SnapshotHeader& header = *headerOf(image);
+                           std::size_t listKey = 0;
+                           while (header.listStarts[listKey + 1] - header.listStarts[listKey] < 2) {
+                             ++listKey;
+                           }
+                           SnapshotRecord* records = recordsOf(image);
+                           std::swap(records[header.listStarts[listKey]], records[header.listStarts[listKey] + 1]);
+                         },
+                         "a list whose records are not sorted by ID was accepted");
+
+  // Changes the initial of the first ID, which keeps the ID well-formed.
+  checkRejectsCorruption(validImage, items,
+                         [&](std::string& image) {
+                           char& initial = image[headerOf(image)->stringTableOffset + recordsOf(image)[0].idOffset];
+                           initial = static_cast<char>('A' + (initial - 'A' + 1) % 26);
+                         },
+                         "a record stored in the wrong list was accepted");
+}
+
+// -----------------------------------------------------------------------------
+// BuildParallel
+// -----------------------------------------------------------------------------
+
+// Everything about dataStructure a failed BuildParallel must not change: the
+// items in iteration order, the shape of the table (which shows an empty
+// bucket left allocated) and the items the time index returns.
+std::vector<std::string> describeContents(const DataStructure& dataStructure) {
+  std::vector<std::string> description;
+  for (const Item& storedItem : dataStructure) {
+    description.push_back(std::string(storedItem.GetID()) + '|' + std::to_string(storedItem.Code) + '|' +
+                          storedItem.pTime);
+  }
+  const DataStructure::Stats stats = dataStructure.GetStats();
+  description.push_back("items " + std::to_string(stats.itemCount) + ", buckets " +
+                        std::to_string(stats.allocatedBucketCount) + ", lists " +
+                        std::to_string(stats.nonEmptyListCount) + ", longest " +
+                        std::to_string(stats.longestListLength));
+  for (const std::size_t bucketItemCount : stats.bucketItemCounts) {
+    description.push_back(std::to_string(bucketItemCount));
+  }
+  for (const std::size_t listLengthCount : stats.listLengthCounts) {
+    description.push_back(std::to_string(listLengthCount));
+  }
+  dataStructure.ForEachInTimeRange("00:00:00", "23:59:59", [&description](const Item& storedItem) {
+    description.push_back(std::string("time ") + storedItem.GetID());
+  });
+  return description;
+}
+
+// Fails each allocation of BuildParallel in turn (the later ones in
+// slowly growing steps), for both layouts with and without the indexes and the
+// string pool and on several threads. A failure may hit a worker, a thread
+// start, an item copy or an index, and must leave the structure as it was:
+// no item of the call stored or indexed, and no bucket allocated for it.
+void testBuildParallelRollsBackFailures() {
+  // The stored items start with A to M, so that some of the added ones need
+  // a new bucket; a few of the added ones are stored already.
+  std::vector<Item> storedItems;
+  std::vector<Item> addedItems;
+  for (Item& item : generateItems(600)) {
+    if (item.GetID()[0] < 'N' && storedItems.size() < 150) {
+      storedItems.push_back(std::move(item));
+    } else if (addedItems.size() < 150) {
+      addedItems.push_back(std::move(item));
+    }
+  }
+  const std::size_t newItemCount = addedItems.size();
+  for (std::size_t itemIndex = 0; itemIndex < 20; ++itemIndex) {
+    addedItems.push_back(storedItems[itemIndex * 7]);
+  }
+
+  std::vector<DataStructure::Options> optionSets;
+  for (const DataStructure::BucketLayout bucketLayout :
+       {DataStructure::BucketLayout::LinkedLists, DataStructure::BucketLayout::HashedArrays}) {
+    DataStructure::Options options = layoutOptions(bucketLayout);
+    optionSets.push_back(options);
+    options.useIdIndex = true;
+    options.useCodeIndex = true;
+    options.useTimeIndex = true;
+    optionSets.push_back(options);
+    options = layoutOptions(bucketLayout);
+    options.useStringArena = true;
+    optionSets.push_back(options);
+  }
+
+  for (const DataStructure::Options& options : optionSets) {
+    for (const unsigned threadCount : {1u, 2u, 4u}) {
+      DataStructure dataStructure(options);
+      for (const Item& item : storedItems) {
+        dataStructure += Item(item);
+      }
+      const std::vector<std::string> originalContents = describeContents(dataStructure);
+
+      for (long failingAllocation = 0;; failingAllocation += 1 + failingAllocation / 64) {
+        allocationsBeforeFailure.store(failingAllocation);
+        bool isFailed = false;
+        int addedCount = 0;
+        try {
+          addedCount = dataStructure.BuildParallel(addedItems, threadCount);
+        } catch (const std::bad_alloc&) {
+          isFailed = true;
+        }
+        allocationsBeforeFailure.store(-1);
+
+        if (!isFailed) {
+          check(addedCount == static_cast<int>(newItemCount), "BuildParallel added the wrong number of items");
+          std::vector<Item> expectedItems = storedItems;
+          expectedItems.insert(expectedItems.end(), addedItems.begin(), addedItems.begin() + newItemCount);
+          checkHoldsItems(dataStructure, expectedItems);
+          break;
+        }
+        check(describeContents(dataStructure) == originalContents, "a failed BuildParallel changed the structure");
+        for (std::size_t itemIndex = 0; itemIndex < newItemCount; ++itemIndex) {
+          const Item& addedItem = addedItems[itemIndex];
+          check(!dataStructure.GetItem(std::string_view(addedItem.GetID())),
+                "a failed BuildParallel left an item findable");
+          dataStructure.ForEachWithCode(addedItem.Code, [&addedItem](const Item& matchingItem) {
+            check(std::strcmp(matchingItem.GetID(), addedItem.GetID()) != 0,
+                  "a failed BuildParallel left an item in the code index");
+          });
+        }
+      }
+    }
+  }
+}
+
+// -----------------------------------------------------------------------------
+// IngestionPipeline
+// -----------------------------------------------------------------------------
+
+// Plugs source into the ID-based Item constructors while it exists.
+struct ScopedItemSource {
+  explicit ScopedItemSource(ItemSource& source) { Item::SetItemSource(&source); }
+  ~ScopedItemSource() { Item::SetItemSource(nullptr); }
+
+  ScopedItemSource(const ScopedItemSource&) = delete;
+  ScopedItemSource& operator=(const ScopedItemSource&) = delete;
+};
+
+// Generates items like a SyntheticItemSource, but throws std::logic_error
+// from every FetchItem after the first fetchesBeforeFailure, and counts the
+// items handed out and not released yet.
+class FailingItemSource : public ItemSource
+{
+public:
+  explicit FailingItemSource(std::size_t fetchesBeforeFailure) : mFetchesBeforeFailure(fetchesBeforeFailure) {
+    SyntheticItemSource::Options sourceOptions;
+    sourceOptions.uniqueIdentifiers = true;
+    mSource = std::make_unique<SyntheticItemSource>(sourceOptions);
+  }
+
+  ITEM1* FetchItem(char* pID) override {
+    if (mFetchCount.fetch_add(1, std::memory_order_relaxed) >= mFetchesBeforeFailure) {
+      throw std::logic_error("Injected item source failure");
+    }
+    ITEM1* fetchedItem = mSource->FetchItem(pID);
+    mOutstandingCount.fetch_add(1, std::memory_order_relaxed);
+    return fetchedItem;
+  }
+
+  void Release(ITEM1* item) override {
+    if (item) {
+      mOutstandingCount.fetch_sub(1, std::memory_order_relaxed);
+    }
+    mSource->Release(item);
+  }
+
+  long GetOutstandingCount() const { return mOutstandingCount.load(std::memory_order_relaxed); }
+
+private:
+  std::unique_ptr<SyntheticItemSource> mSource;
+  std::size_t mFetchesBeforeFailure;
+  std::atomic<std::size_t> mFetchCount{0};
+  std::atomic<long> mOutstandingCount{0};
+};
+
+// Streams IDs with invalid ones, repeats, empty lines and "\r\n" endings
+// mixed in through pipelines of several shapes; the Result counters must
+// account for every line and the target must hold each valid ID once.
+// Running the same stream again rejects everything.
+void testPipelineCountsEveryRecord() {
+  constexpr std::size_t REPEAT_STRIDE = 10;
+  const std::vector<Item> items = generateItems(400);
+  const char* const invalidIdentifiers[] = {"Cafe", "cafe Noir", "Cafe noir", "Cafe ", " Noir"};
+
+  std::string feed;
+  std::size_t repeatCount = 0;
+  std::size_t invalidCount = 0;
+  for (std::size_t itemIndex = 0; itemIndex < items.size(); ++itemIndex) {
+    feed += items[itemIndex].GetID();
+    feed += itemIndex % 3 == 0 ? "\r\n" : "\n";
+    if (itemIndex % REPEAT_STRIDE == 0) {
+      feed += "\n\r\n";
+      feed += items[itemIndex / 2].GetID();
+      feed += '\n';
+      ++repeatCount;
+    }
+    if (itemIndex % REPEAT_STRIDE == 5) {
+      feed += invalidIdentifiers[invalidCount++ % std::size(invalidIdentifiers)];
+      feed += '\n';
+    }
+  }
+
+  SyntheticItemSource source;
+  const ScopedItemSource scopedSource(source);
+  for (const std::size_t queueCapacity : {std::size_t(2), std::size_t(1024)}) {
+    for (const unsigned shardCount : {1u, 3u}) {
+      ConcurrentDataStructure target;
+      IngestionPipeline::Options pipelineOptions;
+      pipelineOptions.queueCapacity = queueCapacity;
+      pipelineOptions.shardCount = shardCount;
+      IngestionPipeline pipeline(target, pipelineOptions);
+
+      std::istringstream firstFeed(feed);
+      const IngestionPipeline::Result result = pipeline.RunFromStream(firstFeed);
+      check(result.produced == items.size() + repeatCount + invalidCount, "the produced count is wrong");
+      check(result.invalid == invalidCount, "the invalid count is wrong");
+      check(result.added == items.size(), "the added count is wrong");
+      check(result.rejected == repeatCount, "the rejected count is wrong");
+      check(target.GetItemsNumber() == static_cast<int>(items.size()), "the target holds the wrong number of items");
+      for (const Item& item : items) {
+        check(target.ReadItem(item.GetID(), [](const Item&) {}), "a streamed item is missing from the target");
+      }
+
+      std::istringstream secondFeed(feed);
+      const IngestionPipeline::Result repeatedResult = pipeline.RunFromStream(secondFeed);
+      check(repeatedResult.added == 0 && repeatedResult.rejected == items.size() + repeatCount &&
+                repeatedResult.invalid == invalidCount,
+            "a repeated stream was not rejected");
+    }
+  }
+}
+
+// A failure other than a rejection in the producer or an inserter stops
+// every stage, and the run rethrows it instead of hanging on a full or
+// empty ring; every item fetched before is handed back to its source.
+void testPipelinePropagatesAborts() {
+  constexpr std::size_t FETCHES_BEFORE_FAILURE = 100;
+  const std::vector<Item> items = generateItems(2000);
+  std::string feed;
+  for (const Item& item : items) {
+    feed += item.GetID();
+    feed += '\n';
+  }
+
+  for (const unsigned shardCount : {1u, 3u}) {
+    IngestionPipeline::Options pipelineOptions;
+    pipelineOptions.queueCapacity = 4;
+    pipelineOptions.shardCount = shardCount;
+
+    // Items fetched by the producer.
+    {
+      FailingItemSource source(FETCHES_BEFORE_FAILURE);
+      const ScopedItemSource scopedSource(source);
+      ConcurrentDataStructure target;
+      IngestionPipeline pipeline(target, pipelineOptions);
+      bool isRethrown = false;
+      try {
+        pipeline.RunFromProvider(items.size());
+      } catch (const std::logic_error&) {
+        isRethrown = true;
+      }
+      check(isRethrown, "a producer failure was not rethrown");
+      check(target.GetItemsNumber() <= static_cast<int>(FETCHES_BEFORE_FAILURE),
+            "items were added after a producer failure");
+      check(source.GetOutstandingCount() == 0, "a fetched item was not released");
+    }
+
+    // Items fetched by the inserters.
+    {
+      FailingItemSource source(FETCHES_BEFORE_FAILURE);
+      const ScopedItemSource scopedSource(source);
+      ConcurrentDataStructure target;
+      IngestionPipeline pipeline(target, pipelineOptions);
+      std::istringstream ids(feed);
+      bool isRethrown = false;
+      try {
+        pipeline.RunFromStream(ids);
+      } catch (const std::logic_error&) {
+        isRethrown = true;
+      }
+      check(isRethrown, "an inserter failure was not rethrown");
+      check(target.GetItemsNumber() <= static_cast<int>(FETCHES_BEFORE_FAILURE),
+            "items were added after an inserter failure");
+      check(source.GetOutstandingCount() == 0, "a fetched item was not released");
+    }
+  }
+}
+
+// -----------------------------------------------------------------------------
+
+struct TestCase {
+  const char* name;
+  void (*run)();
+};
+
+const TestCase TEST_CASES[] = {
+    {"EpochReclamation: retired nodes wait for readers", testRetiredNodesWaitForReaders},
+    {"ReadOptimizedDataStructure: concurrent readers and writers", testReadOptimizedConcurrentReadersAndWriters},
+    {"Snapshots: round trip for both bucket layouts", testSnapshotRoundTrip},
+    {"Snapshots: corrupt files are rejected", testSnapshotRejectsCorruptFiles},
+    {"BuildParallel: failed allocations are rolled back", testBuildParallelRollsBackFailures},
+    {"IngestionPipeline: the counters account for every record", testPipelineCountsEveryRecord},
+    {"IngestionPipeline: a stage failure aborts the run", testPipelinePropagatesAborts},
+};
+
+} // namespace
+
+int main() {
+  int failedCount = 0;
+  int testNumber = 0;
+  for (const TestCase& testCase : TEST_CASES) {
+    ++testNumber;
+    std::cout << "Test " << testNumber << " (" << testCase.name << "): running..." << std::endl;
+    bool isPassed = false;
+    try {
+      testCase.run();
+      isPassed = true;
+    } catch (const std::exception& e) {
+      std::cout << "Exception in Test " << testNumber << ": " << e.what() << std::endl;
+    }
+    std::cout << "Test " << testNumber << " (" << testCase.name << "): " << (isPassed ? "passed" : "failed")
+              << std::endl;
+    failedCount += isPassed ? 0 : 1;
+  }
+  return failedCount;
+}